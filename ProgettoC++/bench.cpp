@@ -0,0 +1,612 @@
+/**
+    @file bench.cpp
+    @brief Benchmark delle operazioni della classe set
+
+    Misura i tempi delle principali operazioni della classe set<T>
+    e li stampa a schermo in ns per operazione.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <cstdio> // std::remove
+#include <thread>
+#include <atomic>
+#include "set.hpp"
+#include "snapshot.hpp"
+#include "set_parallel.hpp"
+#include "concurrent_set.hpp"
+#include "indice_attivita.hpp"
+#include "conta_allocazioni.hpp"
+#include <mutex>
+
+/**
+    @brief Tempo trascorso in nanosecondi tra due istanti
+*/
+double nanosecondi(std::chrono::steady_clock::time_point inizio,
+                   std::chrono::steady_clock::time_point fine){
+    return std::chrono::duration<double, std::nano>(fine - inizio).count();
+}
+
+/**
+    @brief Misura inserimento e svuotamento di un set di interi
+
+    Ripete più volte il riempimento con n interi distinti seguito da clear(),
+    così da confrontare il costo di allocazione e deallocazione dei nodi.
+
+    @tparam Set tipo di set da misurare
+    @param nome nome stampato nel report
+    @param n numero di elementi inseriti per ripetizione
+    @param ripetizioni numero di ripetizioni
+*/
+template<typename Set>
+void bench_add_clear(const char *nome, int n, int ripetizioni){
+    Set s;
+
+    std::chrono::steady_clock::time_point inizio = std::chrono::steady_clock::now();
+    for(int r = 0; r < ripetizioni; ++r){
+        for(int i = 0; i < n; ++i)
+            s.add(i);
+        s.clear();
+    }
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+
+    std::cout << "  " << nome << " add+clear n=" << n << ": "
+              << nanosecondi(inizio, fine) / (double(n) * ripetizioni) << " ns/op" << std::endl;
+}
+
+/**
+    @brief Misura inserimenti e rimozioni alternati di stringhe
+
+    @tparam Set tipo di set da misurare
+    @param nome nome stampato nel report
+    @param n numero di elementi
+*/
+template<typename Set>
+void bench_add_remove_string(const char *nome, int n){
+    Set s;
+
+    std::chrono::steady_clock::time_point inizio = std::chrono::steady_clock::now();
+    for(int i = 0; i < n; ++i)
+        s.add("attivita " + std::to_string(i));
+    for(int i = 0; i < n; i += 2)
+        s.remove("attivita " + std::to_string(i));
+    s.clear();
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+
+    std::cout << "  " << nome << " add+remove string n=" << n << ": "
+              << nanosecondi(inizio, fine) / (n + n / 2) << " ns/op" << std::endl;
+}
+
+/**
+    @brief Misura il caricamento di un intervallo con il costruttore da iteratori
+
+    @param n numero di elementi dell'intervallo (metà sono duplicati)
+*/
+void bench_insert_bulk(int n){
+    std::vector<int> v;
+    for(int i = 0; i < n; ++i)
+        v.push_back(i / 2);
+
+    std::chrono::steady_clock::time_point inizio = std::chrono::steady_clock::now();
+    set<int> s(v.begin(), v.end());
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+
+    std::cout << "  costruttore da iteratori n=" << n << ": "
+              << nanosecondi(inizio, fine) / 1e6 << " ms ("
+              << nanosecondi(inizio, fine) / n << " ns/elemento, size " << s.size() << ")" << std::endl;
+}
+
+/**
+    @brief Caricamento con il vecchio parser basato su std::getline e operator>>
+
+    Usato solo come riferimento per il confronto con load().
+*/
+void load_con_stream(const std::string &filename, set<Attivita> &s){
+    std::ifstream file(filename.c_str());
+
+    std::string titolo;
+    int ora_inizio;
+    int ora_fine;
+    char separatore;
+
+    while(std::getline(file, titolo, ';')){
+        file >> ora_inizio;
+        file >> separatore;
+        file >> ora_fine;
+        file.ignore();
+
+        Attivita a;
+        a.titolo = titolo;
+        a.ora_inizio = ora_inizio;
+        a.ora_fine = ora_fine;
+
+        s.add(a);
+    }
+}
+
+/**
+    @brief Misura load() rispetto al vecchio parser a flussi
+
+    @param n numero di attività nel file
+*/
+void bench_load(int n){
+    set<Attivita> s;
+    for(int i = 0; i < n; ++i)
+        s.emplace("Attivita numero " + std::to_string(i), i % 24, (i + 3) % 24);
+    save(s, "bench_attivita.txt");
+
+    set<Attivita> letto;
+    std::chrono::steady_clock::time_point inizio = std::chrono::steady_clock::now();
+    load("bench_attivita.txt", letto);
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+
+    std::cout << "  load n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    set<Attivita> letto_stream;
+    inizio = std::chrono::steady_clock::now();
+    load_con_stream("bench_attivita.txt", letto_stream);
+    fine = std::chrono::steady_clock::now();
+
+    std::cout << "  parser a flussi n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    std::remove("bench_attivita.txt");
+}
+
+/**
+    @brief Salvataggio con il vecchio writer basato su operator<< e std::endl
+
+    Usato solo come riferimento per il confronto con save().
+*/
+void save_con_stream(const set<Attivita> &s, const std::string &filename){
+    std::ofstream file(filename.c_str());
+
+    for(set<Attivita>::const_iterator it = s.begin(); it != s.end(); ++it){
+        file << it->titolo << ";"
+             << it->ora_inizio << ";"
+             << it->ora_fine << std::endl;
+    }
+}
+
+/**
+    @brief Misura save() rispetto al vecchio writer a flussi
+
+    @param n numero di attività da salvare
+*/
+void bench_save(int n){
+    set<Attivita> s;
+    for(int i = 0; i < n; ++i)
+        s.emplace("Attivita numero " + std::to_string(i), i % 24, (i + 3) % 24);
+
+    std::chrono::steady_clock::time_point inizio = std::chrono::steady_clock::now();
+    save(s, "bench_attivita.txt");
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+
+    std::cout << "  save n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    inizio = std::chrono::steady_clock::now();
+    save_con_stream(s, "bench_attivita.txt");
+    fine = std::chrono::steady_clock::now();
+
+    std::cout << "  writer con std::endl n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    std::remove("bench_attivita.txt");
+}
+
+/**
+    @brief Misura la scalabilità di load_parallel() da 1 a 32 thread
+
+    @param n numero di attività nel file
+*/
+void bench_load_parallel(int n){
+    set<Attivita> s;
+    for(int i = 0; i < n; ++i)
+        s.emplace("Attivita numero " + std::to_string(i), i % 24, (i + 3) % 24);
+    save(s, "bench_attivita.txt");
+
+    set<Attivita> letto;
+    std::chrono::steady_clock::time_point inizio = std::chrono::steady_clock::now();
+    load("bench_attivita.txt", letto);
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+    double sequenziale = nanosecondi(inizio, fine);
+
+    std::cout << "  load sequenziale n=" << n << ": " << sequenziale / 1e6 << " ms ("
+              << std::thread::hardware_concurrency() << " core disponibili)" << std::endl;
+
+    for(unsigned int t = 1; t <= 32; t *= 2){
+        inizio = std::chrono::steady_clock::now();
+        load_parallel("bench_attivita.txt", letto, t);
+        fine = std::chrono::steady_clock::now();
+
+        std::cout << "  load_parallel " << t << " thread: " << nanosecondi(inizio, fine) / 1e6
+                  << " ms (speedup " << sequenziale / nanosecondi(inizio, fine) << "x)" << std::endl;
+    }
+
+    std::remove("bench_attivita.txt");
+}
+
+/**
+    @brief Predicato costoso usato da bench_filter_out_parallela
+
+    Simula un controllo di qualche microsecondo per elemento.
+*/
+struct predicato_costoso{
+    bool operator()(int x) const{
+        unsigned long h = static_cast<unsigned long>(x);
+        for(int i = 0; i < 2000; ++i)
+            h = h * 6364136223846793005UL + 1442695040888963407UL;
+        return (h >> 33) % 2 == 0;
+    }
+};
+
+/**
+    @brief Misura filter_out, unione e intersezione sequenziali e parallele
+
+    @param n numero di elementi dei set
+*/
+void bench_set_parallel(int n){
+    set<int> a;
+    set<int> b;
+    for(int i = 0; i < n; ++i){
+        a.add(i);
+        b.add(i * 2);
+    }
+
+    std::cout << "  pool globale: " << thread_pool::globale().size() << " thread" << std::endl;
+
+    std::chrono::steady_clock::time_point inizio = std::chrono::steady_clock::now();
+    set<int> r = filter_out(a, predicato_costoso());
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+    std::cout << "  filter_out sequenziale n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    inizio = std::chrono::steady_clock::now();
+    r = filter_out(parallela(), a, predicato_costoso());
+    fine = std::chrono::steady_clock::now();
+    std::cout << "  filter_out parallela n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    inizio = std::chrono::steady_clock::now();
+    r = a + b;
+    fine = std::chrono::steady_clock::now();
+    std::cout << "  unione sequenziale n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    inizio = std::chrono::steady_clock::now();
+    r = unione(parallela(), a, b);
+    fine = std::chrono::steady_clock::now();
+    std::cout << "  unione parallela n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    inizio = std::chrono::steady_clock::now();
+    r = a - b;
+    fine = std::chrono::steady_clock::now();
+    std::cout << "  intersezione sequenziale n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    inizio = std::chrono::steady_clock::now();
+    r = intersezione(parallela(), a, b);
+    fine = std::chrono::steady_clock::now();
+    std::cout << "  intersezione parallela n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+}
+
+/**
+    @brief set protetto da un unico mutex, riferimento per concurrent_set
+*/
+struct set_con_mutex{
+    std::mutex m;
+    set<int> s;
+
+    void add(int x){
+        std::lock_guard<std::mutex> lock(m);
+        s.add(x);
+    }
+
+    bool contains(int x){
+        std::lock_guard<std::mutex> lock(m);
+        return s.contains(x);
+    }
+};
+
+/**
+    @brief Misura il throughput di più thread che leggono e scrivono sullo stesso set
+
+    Ogni thread esegue operazioni_per_thread operazioni: un inserimento ogni
+    cinque operazioni, le altre sono ricerche.
+
+    @tparam Set tipo di set da misurare
+    @param nome nome stampato nel report
+    @param thread numero di thread
+    @param operazioni_per_thread operazioni eseguite da ogni thread
+*/
+template<typename Set>
+void bench_throughput_concorrente(const char *nome, unsigned int thread, int operazioni_per_thread){
+    Set s;
+    std::vector<std::thread> threads;
+    std::atomic<long> trovati(0);
+
+    std::chrono::steady_clock::time_point inizio = std::chrono::steady_clock::now();
+    for(unsigned int t = 0; t < thread; ++t){
+        threads.push_back(std::thread([&s, &trovati, t, operazioni_per_thread]{
+            long locali = 0;
+            for(int i = 0; i < operazioni_per_thread; ++i){
+                int x = static_cast<int>(t) * operazioni_per_thread + i;
+                if(i % 5 == 0)
+                    s.add(x);
+                else if(s.contains(x - i % 5))
+                    ++locali;
+            }
+            trovati += locali;
+        }));
+    }
+    for(std::size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+
+    double operazioni = double(thread) * operazioni_per_thread;
+    std::cout << "  " << nome << " " << thread << " thread: "
+              << operazioni / (nanosecondi(inizio, fine) / 1e9) / 1e6 << " Mop/s" << std::endl;
+}
+
+/**
+    @brief Attività con il tipo di titolo indicato, qualunque sia titolo_attivita
+
+    Usata solo per confrontare i titoli in std::string con i titoli internati.
+*/
+template<typename Titolo>
+struct attivita_con_titolo{
+    Titolo titolo;
+    int ora_inizio;
+    int ora_fine;
+
+    bool operator==(const attivita_con_titolo &other) const{
+        return titolo == other.titolo && ora_inizio == other.ora_inizio && ora_fine == other.ora_fine;
+    }
+};
+
+/**
+    @brief Hash di attivita_con_titolo, calcolato come std::hash<Attivita>
+*/
+template<typename Titolo>
+struct hash_attivita_con_titolo{
+    std::size_t operator()(const attivita_con_titolo<Titolo> &a) const{
+        std::size_t h = std::hash<Titolo>()(a.titolo);
+        h ^= std::hash<int>()(a.ora_inizio) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<int>()(a.ora_fine) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+/**
+    @brief Misura memoria e contains con i titoli internati e con std::string
+
+    @tparam Elemento tipo di attività
+    @tparam Set tipo di set
+    @param nome nome stampato nel report
+    @param n numero di attività
+    @param titoli numero di titoli distinti
+*/
+template<typename Elemento, typename Set>
+void bench_titoli(const char *nome, int n, int titoli){
+    std::vector<Elemento> elementi;
+    elementi.reserve(n);
+    for(int i = 0; i < n; ++i){
+        Elemento e = { "Riunione di progetto n. " + std::to_string(i % titoli), (i / titoli) % 24, (i / titoli) / 24 };
+        elementi.push_back(e);
+    }
+
+    unsigned long prima = byte_allocati;
+    Set s;
+    for(int i = 0; i < n; ++i)
+        s.add(elementi[i]);
+    unsigned long memoria = byte_allocati - prima;
+
+    std::chrono::steady_clock::time_point inizio = std::chrono::steady_clock::now();
+    long trovati = 0;
+    for(int i = 0; i < n; ++i)
+        trovati += s.contains(elementi[i]);
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+
+    std::cout << "  " << nome << " n=" << n << ", " << titoli << " titoli: "
+              << double(memoria) / n << " byte/attivita, contains "
+              << nanosecondi(inizio, fine) / n << " ns/op (trovati " << trovati << ")" << std::endl;
+}
+
+/**
+    @brief Filtro usato da bench_load_filtered
+*/
+bool inizia_di_mattina(const Attivita &a){
+    return a.ora_inizio < 6;
+}
+
+/**
+    @brief Misura load_filtered() rispetto a load() seguito da filter_out()
+
+    @param n numero di attività nel file (circa un quarto passa il filtro)
+*/
+void bench_load_filtered(int n){
+    set<Attivita> s;
+    for(int i = 0; i < n; ++i)
+        s.emplace("Attivita numero " + std::to_string(i), i % 24, (i + 3) % 24);
+    save(s, "bench_attivita.txt");
+
+    set<Attivita> filtrato;
+    std::chrono::steady_clock::time_point inizio = std::chrono::steady_clock::now();
+    load_filtered("bench_attivita.txt", filtrato, inizia_di_mattina);
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+
+    std::cout << "  load_filtered n=" << n << ": " << nanosecondi(inizio, fine) / 1e6
+              << " ms (tenute " << filtrato.size() << ")" << std::endl;
+
+    inizio = std::chrono::steady_clock::now();
+    set<Attivita> tutto;
+    load("bench_attivita.txt", tutto);
+    filtrato = filter_out(tutto, inizia_di_mattina);
+    fine = std::chrono::steady_clock::now();
+
+    std::cout << "  load + filter_out n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    std::remove("bench_attivita.txt");
+}
+
+/**
+    @brief Misura load_snapshot() e l'apertura di snapshot_view rispetto a load()
+
+    @param n numero di attività (i titoli si ripetono ogni 1000 attività)
+*/
+void bench_snapshot(int n){
+    set<Attivita> s;
+    for(int i = 0; i < n; ++i)
+        s.emplace("Attivita numero " + std::to_string(i % 1000), i % 24, i / 24);
+    save(s, "bench_attivita.txt");
+    save_snapshot(s, "bench_attivita.bin");
+
+    set<Attivita> letto;
+    std::chrono::steady_clock::time_point inizio = std::chrono::steady_clock::now();
+    load("bench_attivita.txt", letto);
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+
+    std::cout << "  load testo n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    inizio = std::chrono::steady_clock::now();
+    load_snapshot("bench_attivita.bin", letto);
+    fine = std::chrono::steady_clock::now();
+
+    std::cout << "  load_snapshot n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    inizio = std::chrono::steady_clock::now();
+    long somma = 0;
+    {
+        snapshot_view v("bench_attivita.bin");
+        for(std::size_t i = 0; i < v.size(); ++i)
+            somma += v[i].ora_fine + static_cast<long>(v[i].titolo.size());
+    }
+    fine = std::chrono::steady_clock::now();
+
+    std::cout << "  snapshot_view apertura+scansione n=" << n << ": "
+              << nanosecondi(inizio, fine) / 1e6 << " ms (checksum " << somma << ")" << std::endl;
+
+    std::remove("bench_attivita.txt");
+    std::remove("bench_attivita.bin");
+}
+
+/**
+    @brief Predicato per filter_out: attività che si sovrappongono a una fascia oraria
+*/
+struct nella_fascia{
+    int inizio;
+    int fine;
+
+    bool operator()(const Attivita &a) const{
+        return a.ora_inizio < fine && a.ora_fine > inizio && a.ora_inizio < a.ora_fine;
+    }
+};
+
+/**
+    @brief Misura le ricerche per fascia oraria di indice_attivita rispetto a filter_out
+
+    @param n numero di attività, distribuite su una settimana in minuti
+    @param ricerche numero di fasce orarie cercate
+*/
+void bench_indice_attivita(int n, int ricerche){
+    set<Attivita> s;
+    unsigned int seme = 1;
+    for(int i = 0; i < n; ++i){
+        seme = seme * 1103515245u + 12345u;
+        int inizio = static_cast<int>((seme >> 4) % 10080);
+        s.emplace("Attivita numero " + std::to_string(i % 1000), inizio, inizio + 30 + i % 60);
+    }
+
+    std::chrono::steady_clock::time_point inizio = std::chrono::steady_clock::now();
+    indice_attivita idx(s);
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+
+    std::cout << "  costruzione indice n=" << n << ": " << nanosecondi(inizio, fine) / 1e6 << " ms" << std::endl;
+
+    long trovate = 0;
+    inizio = std::chrono::steady_clock::now();
+    for(int q = 0; q < ricerche; ++q){
+        int a = (q * 7919) % 10080;
+        idx.sovrapposte(a, a + 15, [&trovate](const Attivita &){ ++trovate; });
+    }
+    fine = std::chrono::steady_clock::now();
+
+    std::cout << "  indice_attivita::sovrapposte n=" << n << ": " << nanosecondi(inizio, fine) / ricerche / 1e3
+              << " us/ricerca (trovate " << trovate << ")" << std::endl;
+
+    long trovate_scan = 0;
+    int ricerche_scan = ricerche / 100 > 0 ? ricerche / 100 : 1;
+    inizio = std::chrono::steady_clock::now();
+    for(int q = 0; q < ricerche_scan; ++q){
+        int a = (q * 7919) % 10080;
+        nella_fascia p = {a, a + 15};
+        trovate_scan += filter_out(s, p).size();
+    }
+    fine = std::chrono::steady_clock::now();
+
+    std::cout << "  filter_out n=" << n << ": " << nanosecondi(inizio, fine) / ricerche_scan / 1e3
+              << " us/ricerca (trovate " << trovate_scan << ")" << std::endl;
+}
+
+/**
+    @brief Esegue tutti i benchmark
+*/
+int main(){
+    typedef set<int> set_pool;
+    typedef set<int, std::hash<int>, std::allocator<int> > set_new_delete;
+
+    typedef set<std::string> set_string_pool;
+    typedef set<std::string, std::hash<std::string>, std::allocator<std::string> > set_string_new_delete;
+
+    std::cout << "[BENCH] allocazione dei nodi: pool_allocator vs new/delete" << std::endl;
+
+    bench_add_clear<set_pool>("pool_allocator", 1000000, 5);
+    bench_add_clear<set_new_delete>("std::allocator", 1000000, 5);
+
+    bench_add_remove_string<set_string_pool>("pool_allocator", 1000000);
+    bench_add_remove_string<set_string_new_delete>("std::allocator", 1000000);
+
+    std::cout << "[BENCH] inserimento in blocco" << std::endl;
+
+    bench_insert_bulk(1000000);
+
+    std::cout << "[BENCH] caricamento da file" << std::endl;
+
+    bench_load(500000);
+
+    std::cout << "[BENCH] salvataggio su file" << std::endl;
+
+    bench_save(500000);
+
+    std::cout << "[BENCH] caricamento con piu' thread" << std::endl;
+
+    bench_load_parallel(2000000);
+
+    std::cout << "[BENCH] algoritmi paralleli" << std::endl;
+
+    bench_set_parallel(200000);
+
+    std::cout << "[BENCH] set concorrente: 80% ricerche, 20% inserimenti" << std::endl;
+
+    for(unsigned int t = 1; t <= 8; t *= 2){
+        bench_throughput_concorrente<set_con_mutex>("set + mutex", t, 500000);
+        bench_throughput_concorrente<concurrent_set<int> >("concurrent_set", t, 500000);
+    }
+
+    std::cout << "[BENCH] titoli internati vs std::string" << std::endl;
+
+    bench_titoli<attivita_con_titolo<std::string>, set<attivita_con_titolo<std::string>, hash_attivita_con_titolo<std::string> > >("std::string", 1000000, 300);
+    bench_titoli<attivita_con_titolo<titolo_internato>, set<attivita_con_titolo<titolo_internato>, hash_attivita_con_titolo<titolo_internato> > >("titolo_internato", 1000000, 300);
+
+    std::cout << "[BENCH] caricamento filtrato" << std::endl;
+
+    bench_load_filtered(500000);
+
+    std::cout << "[BENCH] snapshot binario" << std::endl;
+
+    bench_snapshot(500000);
+
+    std::cout << "[BENCH] ricerche per fascia oraria" << std::endl;
+
+    bench_indice_attivita(500000, 10000);
+
+    return 0;
+}
@@ -0,0 +1,521 @@
+/**
+    @file bench_suite.cpp
+    @brief Suite di microbenchmark per le operazioni di set.hpp
+
+    Misura add, contains, remove, operator[], iterazione, unione,
+    intersezione, filter_out, save e load per set<int>, set<std::string>
+    e set<Attivita>, con N da 10 fino a 10^7 (potenze di 10).
+    Per ogni misura riporta ns per operazione (tempo reale e di CPU),
+    allocazioni per operazione e operazioni al secondo.
+
+    Opzioni:
+    - --max-n=N        dimensione massima (default 10000000)
+    - --min-time=S     secondi minimi di misura per benchmark (default 0.2)
+    - --filter=TESTO   esegue solo i benchmark il cui nome contiene TESTO
+    - --json=FILE      scrive i risultati in FILE in formato JSON, con gli stessi
+                       campi di Google Benchmark per poter confrontare due esecuzioni
+*/
+
+#include <iostream>
+#include <iomanip> // std::setw
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <ctime> // std::clock, std::time, std::strftime
+#include <cstdlib> // std::strtol
+#include <cstdio> // std::remove
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread> // std::thread::hardware_concurrency
+#include "set.hpp"
+#include "conta_allocazioni.hpp"
+
+/**
+    @brief Cronometro che accumula tempo reale, tempo di CPU e allocazioni
+
+    Misura solo le parti racchiuse tra avvia() e ferma(), così la
+    preparazione dei dati e la distruzione dei risultati non vengono contate.
+*/
+class cronometro{
+
+    std::chrono::steady_clock::time_point _inizio;
+    std::clock_t _inizio_cpu;
+    unsigned long _allocazioni_inizio;
+    double _ns; // tempo reale accumulato
+    double _ns_cpu; // tempo di CPU accumulato
+    unsigned long _allocazioni; // allocazioni accumulate
+
+    public:
+
+    cronometro() : _inizio_cpu(0), _allocazioni_inizio(0), _ns(0), _ns_cpu(0), _allocazioni(0) {}
+
+    void avvia(){
+        _allocazioni_inizio = allocazioni;
+        _inizio_cpu = std::clock();
+        _inizio = std::chrono::steady_clock::now();
+    }
+
+    void ferma(){
+        std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+        std::clock_t fine_cpu = std::clock();
+
+        _ns += std::chrono::duration<double, std::nano>(fine - _inizio).count();
+        _ns_cpu += double(fine_cpu - _inizio_cpu) * 1e9 / CLOCKS_PER_SEC;
+        _allocazioni += allocazioni - _allocazioni_inizio;
+    }
+
+    double ns() const{
+        return _ns;
+    }
+
+    double ns_cpu() const{
+        return _ns_cpu;
+    }
+
+    unsigned long numero_allocazioni() const{
+        return _allocazioni;
+    }
+};
+
+/**
+    @brief Risultato di un benchmark
+*/
+struct risultato_bench{
+    std::string nome; // operazione<tipo>/n
+    long iterazioni; // operazioni misurate
+    double ns_op; // tempo reale per operazione
+    double ns_cpu_op; // tempo di CPU per operazione
+    double allocazioni_op; // allocazioni per operazione
+    double op_s; // operazioni al secondo
+};
+
+/**
+    @brief Opzioni della riga di comando
+*/
+struct opzioni{
+    long max_n;
+    double tempo_minimo; // secondi
+    std::string filtro;
+    std::string json;
+};
+
+/**
+    @brief Esegue un benchmark e ne registra il risultato
+
+    Il corpo viene chiamato con un lotto di ripetizioni, scelto in modo che
+    ogni chiamata tratti circa 10^5 elementi, finché il tempo misurato non
+    raggiunge il minimo richiesto. Il corpo restituisce il numero di
+    operazioni eseguite.
+
+    @tparam Corpo funtore chiamato con (cronometro&, lotto)
+    @param operazione nome dell'operazione
+    @param tipo nome del tipo degli elementi
+    @param n numero di elementi
+    @param o opzioni della riga di comando
+    @param corpo funtore che esegue e misura il lotto
+    @param risultati vettore a cui aggiungere il risultato
+*/
+template<typename Corpo>
+void esegui(const char *operazione, const char *tipo, long n, const opzioni &o,
+            Corpo corpo, std::vector<risultato_bench> &risultati){
+    std::ostringstream nome;
+    nome << operazione << "<" << tipo << ">/" << n;
+
+    if(nome.str().find(o.filtro) == std::string::npos)
+        return;
+
+    const long lotto = std::max(1L, 100000 / n);
+    cronometro c;
+    long operazioni = 0;
+    int chiamate = 0;
+
+    do{
+        operazioni += corpo(c, lotto);
+        ++chiamate;
+    }while(c.ns() < o.tempo_minimo * 1e9 && chiamate < 100000);
+
+    risultato_bench r;
+    r.nome = nome.str();
+    r.iterazioni = operazioni;
+    r.ns_op = c.ns() / operazioni;
+    r.ns_cpu_op = c.ns_cpu() / operazioni;
+    r.allocazioni_op = double(c.numero_allocazioni()) / operazioni;
+    r.op_s = operazioni / (c.ns() / 1e9);
+    risultati.push_back(r);
+
+    std::cout << std::left << std::setw(40) << r.nome << std::right
+              << std::setw(14) << std::fixed << std::setprecision(1) << r.ns_op
+              << std::setw(14) << r.ns_cpu_op
+              << std::setw(12) << std::setprecision(3) << r.allocazioni_op
+              << std::setw(16) << std::setprecision(0) << r.op_s
+              << std::setw(14) << r.iterazioni << std::endl;
+}
+
+/**
+    @brief Valori usati dai benchmark, distinti per ogni i
+*/
+template<typename T>
+T genera(long i);
+
+template<>
+int genera<int>(long i){
+    return static_cast<int>(i);
+}
+
+template<>
+std::string genera<std::string>(long i){
+    return "valore " + std::to_string(i);
+}
+
+template<>
+Attivita genera<Attivita>(long i){
+    Attivita a = { "Attivita " + std::to_string(i / 24), static_cast<int>(i % 24), static_cast<int>(i % 24) + 1 };
+    return a;
+}
+
+template<typename T>
+const char* nome_tipo();
+
+template<>
+const char* nome_tipo<int>(){
+    return "int";
+}
+
+template<>
+const char* nome_tipo<std::string>(){
+    return "string";
+}
+
+template<>
+const char* nome_tipo<Attivita>(){
+    return "Attivita";
+}
+
+/**
+    @brief Predicato che tiene circa metà degli elementi, usato da filter_out
+*/
+struct tieni_meta{
+    bool operator()(int x) const{
+        return x % 2 == 0;
+    }
+
+    bool operator()(const std::string &s) const{
+        return s[s.size() - 1] % 2 == 0;
+    }
+
+    bool operator()(const Attivita &a) const{
+        return a.ora_inizio % 2 == 0;
+    }
+};
+
+/**
+    @brief Operazioni misurate dalla suite
+*/
+const char* const OPERAZIONI[] = {
+    "add", "contains", "contains_assente", "remove", "operator[]", "iterazione",
+    "unione", "intersezione", "filter_out", "save", "load"
+};
+
+/**
+    @brief Indica se il filtro seleziona almeno un benchmark per tipo e n
+
+    Evita di preparare i dati (costoso per n grandi) quando non servono.
+*/
+bool almeno_uno(const char *tipo, long n, const opzioni &o){
+    for(std::size_t i = 0; i < sizeof(OPERAZIONI) / sizeof(OPERAZIONI[0]); ++i){
+        std::ostringstream nome;
+        nome << OPERAZIONI[i] << "<" << tipo << ">/" << n;
+        if(nome.str().find(o.filtro) != std::string::npos)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+    @brief Esegue tutti i benchmark sulle operazioni in memoria per il tipo T
+
+    @tparam T tipo degli elementi
+    @param n numero di elementi
+    @param o opzioni della riga di comando
+    @param risultati vettore a cui aggiungere i risultati
+*/
+template<typename T>
+void suite(long n, const opzioni &o, std::vector<risultato_bench> &risultati){
+    typedef set<T> set_type;
+    const char *tipo = nome_tipo<T>();
+
+    if(!almeno_uno(tipo, n, o))
+        return;
+
+    std::vector<T> valori;
+    valori.reserve(n);
+    for(long i = 0; i < n; ++i)
+        valori.push_back(genera<T>(i));
+
+    const set_type pieno(valori.begin(), valori.end());
+
+    // secondo operando di unione e intersezione: metà degli elementi in comune
+    set_type secondo;
+    for(long i = n / 2; i < n + n / 2; ++i)
+        secondo.add(genera<T>(i));
+
+    esegui("add", tipo, n, o, [&](cronometro &c, long lotto){
+        std::vector<set_type> insiemi(lotto);
+        c.avvia();
+        for(long k = 0; k < lotto; ++k){
+            for(long i = 0; i < n; ++i)
+                insiemi[k].add(valori[i]);
+        }
+        c.ferma();
+        return lotto * n;
+    }, risultati);
+
+    esegui("contains", tipo, n, o, [&](cronometro &c, long lotto){
+        long trovati = 0;
+        c.avvia();
+        for(long k = 0; k < lotto; ++k){
+            for(long i = 0; i < n; ++i)
+                trovati += pieno.contains(valori[i]);
+        }
+        c.ferma();
+        if(trovati != lotto * n)
+            std::cerr << "contains: risultato inatteso" << std::endl;
+        return lotto * n;
+    }, risultati);
+
+    esegui("contains_assente", tipo, n, o, [&](cronometro &c, long lotto){
+        std::vector<T> assenti;
+        assenti.reserve(n);
+        for(long i = 0; i < n; ++i)
+            assenti.push_back(genera<T>(n + i));
+
+        long trovati = 0;
+        c.avvia();
+        for(long k = 0; k < lotto; ++k){
+            for(long i = 0; i < n; ++i)
+                trovati += pieno.contains(assenti[i]);
+        }
+        c.ferma();
+        if(trovati != 0)
+            std::cerr << "contains_assente: risultato inatteso" << std::endl;
+        return lotto * n;
+    }, risultati);
+
+    esegui("remove", tipo, n, o, [&](cronometro &c, long lotto){
+        std::vector<set_type> insiemi(lotto, pieno);
+        c.avvia();
+        for(long k = 0; k < lotto; ++k){
+            for(long i = 0; i < n; ++i)
+                insiemi[k].remove(valori[i]);
+        }
+        c.ferma();
+        return lotto * n;
+    }, risultati);
+
+    esegui("operator[]", tipo, n, o, [&](cronometro &c, long lotto){
+        std::size_t somma = 0;
+        c.avvia();
+        for(long k = 0; k < lotto; ++k){
+            for(long i = 0; i < n; ++i)
+                somma += reinterpret_cast<std::size_t>(&pieno[static_cast<unsigned int>(i)]);
+        }
+        c.ferma();
+        return somma == 0 ? 0L : lotto * n;
+    }, risultati);
+
+    esegui("iterazione", tipo, n, o, [&](cronometro &c, long lotto){
+        long visitati = 0;
+        c.avvia();
+        for(long k = 0; k < lotto; ++k){
+            for(typename set_type::const_iterator it = pieno.begin(); it != pieno.end(); ++it)
+                ++visitati;
+        }
+        c.ferma();
+        return visitati;
+    }, risultati);
+
+    esegui("unione", tipo, n, o, [&](cronometro &c, long lotto){
+        std::vector<set_type> risultato(lotto);
+        c.avvia();
+        for(long k = 0; k < lotto; ++k)
+            risultato[k] = pieno + secondo;
+        c.ferma();
+        return lotto * static_cast<long>(pieno.size() + secondo.size());
+    }, risultati);
+
+    esegui("intersezione", tipo, n, o, [&](cronometro &c, long lotto){
+        std::vector<set_type> risultato(lotto);
+        c.avvia();
+        for(long k = 0; k < lotto; ++k)
+            risultato[k] = pieno - secondo;
+        c.ferma();
+        return lotto * static_cast<long>(std::min(pieno.size(), secondo.size()));
+    }, risultati);
+
+    esegui("filter_out", tipo, n, o, [&](cronometro &c, long lotto){
+        std::vector<set_type> risultato(lotto);
+        c.avvia();
+        for(long k = 0; k < lotto; ++k)
+            risultato[k] = filter_out(pieno, tieni_meta());
+        c.ferma();
+        return lotto * n;
+    }, risultati);
+}
+
+/**
+    @brief Esegue i benchmark di save e load su set<Attivita>
+
+    @param n numero di attività
+    @param o opzioni della riga di comando
+    @param risultati vettore a cui aggiungere i risultati
+*/
+void suite_file(long n, const opzioni &o, std::vector<risultato_bench> &risultati){
+    const char *filename = "bench_suite_attivita.txt";
+
+    if(!almeno_uno("Attivita", n, o))
+        return;
+
+    set<Attivita> pieno;
+    for(long i = 0; i < n; ++i)
+        pieno.add(genera<Attivita>(i));
+
+    esegui("save", "Attivita", n, o, [&](cronometro &c, long lotto){
+        c.avvia();
+        for(long k = 0; k < lotto; ++k)
+            save(pieno, filename);
+        c.ferma();
+        return lotto * n;
+    }, risultati);
+
+    save(pieno, filename);
+
+    esegui("load", "Attivita", n, o, [&](cronometro &c, long lotto){
+        std::vector<set<Attivita> > letti(lotto);
+        c.avvia();
+        for(long k = 0; k < lotto; ++k)
+            load(filename, letti[k]);
+        c.ferma();
+        return lotto * n;
+    }, risultati);
+
+    std::remove(filename);
+}
+
+/**
+    @brief Scrive i risultati in formato JSON
+
+    I campi seguono quelli di Google Benchmark (name, iterations,
+    real_time, cpu_time, time_unit, items_per_second), così le esecuzioni
+    di due commit possono essere confrontate con gli stessi strumenti.
+
+    @param filename file di output
+    @param risultati risultati da scrivere
+    @return false se il file non può essere scritto
+*/
+bool scrivi_json(const std::string &filename, const std::vector<risultato_bench> &risultati){
+    std::ofstream out(filename.c_str());
+    if(!out)
+        return false;
+
+    char data[32];
+    std::time_t adesso = std::time(nullptr);
+    std::strftime(data, sizeof(data), "%Y-%m-%dT%H:%M:%S", std::localtime(&adesso));
+
+    out << "{\n";
+    out << "  \"context\": {\n";
+    out << "    \"date\": \"" << data << "\",\n";
+    out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+    out << "    \"library_build_type\": \"release\"\n";
+#else
+    out << "    \"library_build_type\": \"debug\"\n";
+#endif
+    out << "  },\n";
+    out << "  \"benchmarks\": [\n";
+
+    out << std::setprecision(6);
+    for(std::size_t i = 0; i < risultati.size(); ++i){
+        const risultato_bench &r = risultati[i];
+        out << "    {\n";
+        out << "      \"name\": \"" << r.nome << "\",\n";
+        out << "      \"run_name\": \"" << r.nome << "\",\n";
+        out << "      \"run_type\": \"iteration\",\n";
+        out << "      \"iterations\": " << r.iterazioni << ",\n";
+        out << "      \"real_time\": " << r.ns_op << ",\n";
+        out << "      \"cpu_time\": " << r.ns_cpu_op << ",\n";
+        out << "      \"time_unit\": \"ns\",\n";
+        out << "      \"allocs_per_op\": " << r.allocazioni_op << ",\n";
+        out << "      \"items_per_second\": " << r.op_s << "\n";
+        out << "    }" << (i + 1 < risultati.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+
+    return static_cast<bool>(out);
+}
+
+/**
+    @brief Legge le opzioni della riga di comando
+
+    @return false se un'opzione non è valida
+*/
+bool leggi_opzioni(int argc, char *argv[], opzioni &o){
+    for(int i = 1; i < argc; ++i){
+        std::string a = argv[i];
+
+        if(a.compare(0, 8, "--max-n=") == 0)
+            o.max_n = std::strtol(a.c_str() + 8, nullptr, 10);
+        else if(a.compare(0, 11, "--min-time=") == 0)
+            o.tempo_minimo = std::strtod(a.c_str() + 11, nullptr);
+        else if(a.compare(0, 9, "--filter=") == 0)
+            o.filtro = a.substr(9);
+        else if(a.compare(0, 7, "--json=") == 0)
+            o.json = a.substr(7);
+        else
+            return false;
+    }
+
+    return o.max_n >= 10;
+}
+
+/**
+    @brief Esegue la suite di benchmark
+*/
+int main(int argc, char *argv[]){
+    opzioni o;
+    o.max_n = 10000000;
+    o.tempo_minimo = 0.2;
+
+    if(!leggi_opzioni(argc, argv, o)){
+        std::cerr << "Uso: " << argv[0] << " [--max-n=N] [--min-time=S] [--filter=TESTO] [--json=FILE]" << std::endl;
+        return 2;
+    }
+
+    std::vector<risultato_bench> risultati;
+
+    std::cout << std::left << std::setw(40) << "Benchmark" << std::right
+              << std::setw(14) << "ns/op" << std::setw(14) << "CPU ns/op"
+              << std::setw(12) << "alloc/op" << std::setw(16) << "op/s"
+              << std::setw(14) << "operazioni" << std::endl;
+    std::cout << std::string(110, '-') << std::endl;
+
+    for(long n = 10; n <= o.max_n; n *= 10){
+        suite<int>(n, o, risultati);
+        suite<std::string>(n, o, risultati);
+        suite<Attivita>(n, o, risultati);
+        suite_file(n, o, risultati);
+    }
+
+    if(!o.json.empty()){
+        if(!scrivi_json(o.json, risultati)){
+            std::cerr << "Errore scrittura file " << o.json << std::endl;
+            return 1;
+        }
+        std::cout << "Risultati scritti in " << o.json << std::endl;
+    }
+
+    return 0;
+}
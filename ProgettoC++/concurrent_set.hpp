@@ -0,0 +1,257 @@
+/**
+    @file concurrent_set.hpp
+
+    @brief Implementazione della classe concurrent_set templata
+
+    Questo file contiene la classe concurrent_set<T>, una variante di set<T>
+    che può essere usata da più thread contemporaneamente.
+    Gli elementi sono divisi in shard in base all'hash: ogni shard è un set
+    protetto da un proprio std::shared_mutex, quindi letture e scritture su
+    shard diversi non si bloccano a vicenda e più letture sullo stesso shard
+    possono procedere insieme.
+*/
+#ifndef CONCURRENT_SET_HPP
+#define CONCURRENT_SET_HPP
+
+#include <cstddef> // std::size_t
+#include <memory> // std::unique_ptr
+#include <mutex> // std::unique_lock
+#include <shared_mutex>
+#include <functional> // std::hash
+#include <type_traits> // std::is_constructible
+#include <utility> // std::forward, std::move
+#include "set.hpp"
+
+/**
+    @brief Classe concurrent_set templata
+
+    Offre add, contains e remove sicure rispetto ai thread. Le operazioni
+    che riguardano tutto l'insieme (size, clear, snapshot, for_each)
+    bloccano uno shard alla volta: non vedono quindi un'istantanea
+    atomica dell'insieme se ci sono scritture concorrenti, ma non
+    fermano mai tutti gli scrittori insieme.
+
+    @tparam T tipo degli elementi contenuti nel set
+    @tparam Hash funtore di hashing per T (default std::hash<T>)
+    @tparam Alloc allocatore usato per i nodi (default pool_allocator<T>)
+*/
+template<typename T, typename Hash = std::hash<T>, typename Alloc = pool_allocator<T> >
+class concurrent_set{
+
+    typedef set<T, Hash, Alloc> set_type;
+
+    /**
+        @brief Porzione dell'insieme protetta da un proprio lock
+
+        Allineata alla linea di cache per evitare che i lock di shard
+        vicini si contendano la stessa linea.
+    */
+    struct alignas(64) shard{
+        mutable std::shared_mutex m;
+        set_type s;
+    };
+
+    std::unique_ptr<shard[]> _shard;
+    std::size_t _numero_shard; // potenza di 2
+    unsigned int _bit_shard; // log2(_numero_shard)
+    Hash _hasher;
+
+    concurrent_set(const concurrent_set &);
+    concurrent_set& operator=(const concurrent_set &);
+
+    /**
+        @brief Shard che contiene un valore
+
+        Usa i bit alti dell'hash moltiplicato per la costante di Fibonacci,
+        così la scelta dello shard non dipende dai bit bassi usati
+        dalla tabella hash all'interno dello shard.
+    */
+    shard& shard_of(const T &value) const{
+        if(_bit_shard == 0)
+            return _shard[0];
+
+        unsigned long long h = static_cast<unsigned long long>(_hasher(value));
+        h *= 0x9e3779b97f4a7c15ULL;
+        return _shard[static_cast<std::size_t>(h >> (64 - _bit_shard))];
+    }
+
+    template<typename... Args>
+    static T costruisci(std::true_type, Args&&... args){
+        return T(std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    static T costruisci(std::false_type, Args&&... args){
+        return T{std::forward<Args>(args)...};
+    }
+
+    public:
+
+    /**
+        Costruttore
+
+        @param numero_shard numero di shard, arrotondato alla potenza di 2 successiva
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    explicit concurrent_set(std::size_t numero_shard = 64) : _numero_shard(1), _bit_shard(0){
+        while(_numero_shard < numero_shard){
+            _numero_shard *= 2;
+            ++_bit_shard;
+        }
+
+        _shard.reset(new shard[_numero_shard]);
+    }
+
+    /**
+        @brief Numero di shard
+    */
+    std::size_t numero_shard() const{
+        return _numero_shard;
+    }
+
+    /**
+        @brief Inserisce un valore nel set
+
+        Inserisce il valore solo se non è già presente.
+
+        @param value valore da inserire
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void add(const T &value){
+        shard &sh = shard_of(value);
+        std::unique_lock<std::shared_mutex> lock(sh.m);
+        sh.s.add(value);
+    }
+
+    /**
+        @brief Inserisce un valore nel set spostandolo
+
+        @param value valore da inserire
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void add(T &&value){
+        shard &sh = shard_of(value);
+        std::unique_lock<std::shared_mutex> lock(sh.m);
+        sh.s.add(std::move(value));
+    }
+
+    /**
+        @brief Costruisce un valore e lo inserisce nel set
+
+        Il valore viene costruito fuori dal lock (con le graffe se T
+        è un aggregato, come Attivita) e poi spostato nello shard.
+
+        @param args argomenti per la costruzione del valore
+        @throw std::bad_alloc possibile eccezione di allocazione
+        @throw qualunque eccezione sollevata dal costruttore di T
+    */
+    template<typename... Args>
+    void emplace(Args&&... args){
+        typename std::is_constructible<T, Args&&...>::type con_costruttore;
+        add(costruisci(con_costruttore, std::forward<Args>(args)...));
+    }
+
+    /**
+        @brief Verifica se un valore è presente nel set
+
+        @param value valore da cercare
+        @return true se il valore è presente, false altrimenti
+    */
+    bool contains(const T &value) const{
+        const shard &sh = shard_of(value);
+        std::shared_lock<std::shared_mutex> lock(sh.m);
+        return sh.s.contains(value);
+    }
+
+    /**
+        @brief Rimuove un valore dal set
+
+        Se il valore non è presente, il set rimane invariato
+
+        @param value valore da rimuovere
+    */
+    void remove(const T &value){
+        shard &sh = shard_of(value);
+        std::unique_lock<std::shared_mutex> lock(sh.m);
+        sh.s.remove(value);
+    }
+
+    /**
+        @brief Numero di elementi nel set
+
+        Con scritture concorrenti il valore è solo indicativo.
+
+        @return somma delle dimensioni degli shard
+    */
+    std::size_t size() const{
+        std::size_t n = 0;
+
+        for(std::size_t i = 0; i < _numero_shard; ++i){
+            std::shared_lock<std::shared_mutex> lock(_shard[i].m);
+            n += _shard[i].s.size();
+        }
+
+        return n;
+    }
+
+    /**
+        Svuota il set, uno shard alla volta
+    */
+    void clear(){
+        for(std::size_t i = 0; i < _numero_shard; ++i){
+            std::unique_lock<std::shared_mutex> lock(_shard[i].m);
+            _shard[i].s.clear();
+        }
+    }
+
+    /**
+        @brief Copia il contenuto del set in un set non concorrente
+
+        Ogni shard viene copiato tenendo il suo lock in lettura, che blocca
+        gli scrittori di quello shard solo per la durata della copia;
+        le copie vengono poi unite con set::merge fuori dai lock.
+
+        @return set con gli elementi presenti nel momento in cui ogni shard è stato copiato
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    set_type snapshot() const{
+        set_type risultato;
+
+        for(std::size_t i = 0; i < _numero_shard; ++i){
+            set_type copia;
+            {
+                std::shared_lock<std::shared_mutex> lock(_shard[i].m);
+                copia = _shard[i].s;
+            }
+            risultato.merge(copia);
+        }
+
+        return risultato;
+    }
+
+    /**
+        @brief Chiama f su ogni elemento del set
+
+        Come snapshot(), copia uno shard alla volta e chiama f fuori dal lock,
+        quindi f può a sua volta usare questo set.
+
+        @tparam F funtore chiamato con const T&
+        @param f funtore da chiamare
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    template<typename F>
+    void for_each(F f) const{
+        for(std::size_t i = 0; i < _numero_shard; ++i){
+            set_type copia;
+            {
+                std::shared_lock<std::shared_mutex> lock(_shard[i].m);
+                copia = _shard[i].s;
+            }
+
+            for(typename set_type::const_iterator it = copia.begin(); it != copia.end(); ++it)
+                f(*it);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,28 @@
+/**
+    @file conta_allocazioni.cpp
+
+    @brief Operatori new e delete globali che contano le allocazioni
+*/
+#include "conta_allocazioni.hpp"
+#include <cstdlib> // std::malloc, std::free
+#include <new> // std::bad_alloc
+
+std::atomic<unsigned long> allocazioni(0);
+std::atomic<unsigned long> byte_allocati(0);
+
+void* operator new(std::size_t n){
+    allocazioni.fetch_add(1, std::memory_order_relaxed);
+    byte_allocati.fetch_add(n, std::memory_order_relaxed);
+    void *p = std::malloc(n == 0 ? 1 : n);
+    if(p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept{
+    std::free(p);
+}
@@ -0,0 +1,29 @@
+/**
+    @file conta_allocazioni.hpp
+
+    @brief Contatori delle allocazioni dinamiche
+
+    Dichiara i contatori aggiornati dagli operatori new e delete globali
+    sostituiti in conta_allocazioni.cpp, usati dai test per verificare
+    che certe operazioni non allochino memoria e dai benchmark per
+    misurare la memoria occupata. Il programma che li usa deve essere
+    collegato con conta_allocazioni.o.
+*/
+#ifndef CONTA_ALLOCAZIONI_HPP
+#define CONTA_ALLOCAZIONI_HPP
+
+#include <atomic>
+
+/**
+    @brief Numero di chiamate all'operatore new globale
+
+    È atomico perché load_parallel e i benchmark allocano da più thread.
+*/
+extern std::atomic<unsigned long> allocazioni;
+
+/**
+    @brief Byte richiesti all'operatore new globale
+*/
+extern std::atomic<unsigned long> byte_allocati;
+
+#endif
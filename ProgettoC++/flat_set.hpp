@@ -0,0 +1,472 @@
+/**
+    @file flat_set.hpp
+
+    @brief Implementazione della classe flat_set templata
+
+    Questo file contiene la definizione e l'implementazione
+    della classe template flat_set<T>, alternativa a set<T> che mantiene
+    gli elementi ordinati in un unico array contiguo. È pensata per
+    insiemi letti spesso e modificati di rado.
+*/
+#ifndef FLAT_SET_HPP
+#define FLAT_SET_HPP
+
+#include <vector>
+#include <algorithm>
+#include <functional> // std::less
+#include <stdexcept>
+#include <ostream>
+#include <string>
+#include <utility> // std::move
+#include <iterator> // std::make_move_iterator
+#include "set.hpp"
+
+/**
+    @brief Classe flat_set templata
+
+    Rappresenta un insieme di elementi unici di tipo T memorizzati
+    in ordine crescente in un std::vector.
+    contains usa la ricerca binaria (O(log n)), operator[] è O(1) e
+    unione e intersezione sono calcolate con un merge lineare (O(n+m)).
+    add e remove spostano gli elementi successivi e costano O(n).
+
+    Gli iteratori sono ad accesso casuale e in sola lettura, perché
+    modificare un elemento potrebbe romperne l'ordinamento.
+
+    @tparam T tipo degli elementi contenuti nel flat_set
+    @tparam Compare criterio di ordinamento (default std::less<T>)
+*/
+template<typename T, typename Compare = std::less<T> >
+class flat_set{
+
+    std::vector<T> _data; // elementi ordinati e senza duplicati
+    Compare _less; // criterio di ordinamento
+
+    /**
+        @brief Verifica se due valori sono equivalenti secondo Compare
+    */
+    bool equivalenti(const T &a, const T &b) const{
+        return !_less(a, b) && !_less(b, a);
+    }
+
+    /**
+        @brief Ordina _data ed elimina i duplicati
+    */
+    void ordina_e_deduplica(){
+        std::sort(_data.begin(), _data.end(), _less);
+
+        typename std::vector<T>::iterator it = _data.begin();
+        typename std::vector<T>::iterator out = _data.begin();
+
+        while(it != _data.end()){
+            if(out == _data.begin() || _less(*(out - 1), *it)){
+                if(out != it)
+                    *out = *it;
+                ++out;
+            }
+            ++it;
+        }
+
+        _data.erase(out, _data.end());
+    }
+
+    public:
+
+    typedef typename std::vector<T>::const_iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    /**
+        Costruttore di default
+
+        @post size() == 0
+    */
+    flat_set() {}
+
+    /**
+        @brief Costruttore da intervallo di iteratori
+
+        Copia gli elementi di [first, last), li ordina una sola volta
+        ed elimina i duplicati, in O(n log n).
+
+        @tparam Iterator tipo dell'iteratore
+        @param first iteratore all'inizio dell'intervallo
+        @param last iteratore alla fine dell'intervallo
+        @throw qualunque eccezione sollevata durante la copia
+    */
+    template<typename Iterator>
+    flat_set(Iterator first, Iterator last){
+        while(first != last){
+            _data.push_back(static_cast<T>(*first));
+            ++first;
+        }
+
+        ordina_e_deduplica();
+    }
+
+    /**
+        Svuota il flat_set
+
+        @post size() == 0
+    */
+    void clear(){
+        _data.clear();
+    }
+
+    /**
+        Funzione di swap che scambia il flat_set corrente con quello passato come parametro
+
+        @param other flat_set da scambiare
+    */
+    void swap(flat_set &other){
+        _data.swap(other._data);
+        std::swap(_less, other._less);
+    }
+
+    /**
+        @brief Verifica se un valore è presente nel flat_set
+
+        @param p valore da cercare
+        @return true se il valore è presente, false altrimenti
+    */
+    bool contains(const T &p) const{
+        const_iterator it = std::lower_bound(_data.begin(), _data.end(), p, _less);
+        return it != _data.end() && !_less(p, *it);
+    }
+
+    /**
+        @brief Ritorna la dimensione del flat_set
+
+        @return numero di elementi
+    */
+    unsigned int size() const{
+        return static_cast<unsigned int>(_data.size());
+    }
+
+    /**
+        @brief Inserisce un valore nel flat_set
+
+        Inserisce il valore nella sua posizione ordinata solo se non è già presente.
+
+        @param value valore da inserire
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void add(const T &value){
+        typename std::vector<T>::iterator it = std::lower_bound(_data.begin(), _data.end(), value, _less);
+
+        // se già presente, non fare nulla
+        if(it != _data.end() && !_less(value, *it))
+            return;
+
+        _data.insert(it, value);
+    }
+
+    /**
+        @brief Rimuove un valore dal flat_set
+
+        Se il valore non è presente, il flat_set rimane invariato
+
+        @param value valore da rimuovere
+    */
+    void remove(const T &value){
+        typename std::vector<T>::iterator it = std::lower_bound(_data.begin(), _data.end(), value, _less);
+
+        if(it != _data.end() && !_less(value, *it))
+            _data.erase(it);
+    }
+
+    /**
+        @brief Operatore di uguaglianza tra due flat_set
+
+        Essendo entrambi ordinati, il confronto è lineare.
+
+        @param other flat_set da confrontare con l'oggetto corrente
+        @return true se i due flat_set contengono gli stessi elementi, false altrimenti
+    */
+    bool operator==(const flat_set &other) const{
+        if(_data.size() != other._data.size())
+            return false;
+
+        for(typename std::vector<T>::size_type i = 0; i < _data.size(); ++i){
+            if(!equivalenti(_data[i], other._data[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    /**
+        @brief Operatore di accesso in lettura
+
+        Gli elementi sono restituiti in ordine crescente.
+
+        @param i indice dell'elemento
+        @return riferimento costante all'elemento
+        @throw std::out_of_range se l'indice non è valido
+    */
+    const T& operator[](unsigned int i) const{
+        if(i >= _data.size())
+            throw std::out_of_range("Indice fuori dal range");
+
+        return _data[i];
+    }
+
+    /**
+        @brief Operatore di intersezione tra due flat_set
+
+        Restituisce un nuovo flat_set contenente gli elementi
+        presenti in entrambi, calcolato con un merge lineare.
+        L'operatore non modifica i flat_set originali.
+
+        @param other flat_set con cui calcolare l'intersezione
+        @return nuovo flat_set risultato dell'intersezione
+    */
+    flat_set operator-(const flat_set &other) const{
+        flat_set risultato;
+
+        const_iterator a = _data.begin();
+        const_iterator b = other._data.begin();
+
+        while(a != _data.end() && b != other._data.end()){
+            if(_less(*a, *b)){
+                ++a;
+            }else if(_less(*b, *a)){
+                ++b;
+            }else{
+                risultato._data.push_back(*a);
+                ++a;
+                ++b;
+            }
+        }
+
+        return risultato;
+    }
+
+    /**
+        @brief Differenza tra due flat_set
+
+        Restituisce un nuovo flat_set contenente gli elementi del flat_set
+        corrente che non sono presenti in other, calcolato con un merge lineare.
+
+        @param other flat_set da sottrarre
+        @return nuovo flat_set risultato della differenza
+    */
+    flat_set difference(const flat_set &other) const{
+        flat_set risultato;
+
+        const_iterator a = _data.begin();
+        const_iterator b = other._data.begin();
+
+        while(a != _data.end() && b != other._data.end()){
+            if(_less(*a, *b)){
+                risultato._data.push_back(*a);
+                ++a;
+            }else if(_less(*b, *a)){
+                ++b;
+            }else{
+                ++a;
+                ++b;
+            }
+        }
+
+        risultato._data.insert(risultato._data.end(), a, _data.end());
+
+        return risultato;
+    }
+
+    /**
+        @brief Differenza simmetrica tra due flat_set
+
+        Restituisce un nuovo flat_set contenente gli elementi presenti in uno
+        solo dei due, calcolato con un merge lineare.
+
+        @param other flat_set con cui calcolare la differenza simmetrica
+        @return nuovo flat_set risultato della differenza simmetrica
+    */
+    flat_set symmetric_difference(const flat_set &other) const{
+        flat_set risultato;
+
+        const_iterator a = _data.begin();
+        const_iterator b = other._data.begin();
+
+        while(a != _data.end() && b != other._data.end()){
+            if(_less(*a, *b)){
+                risultato._data.push_back(*a);
+                ++a;
+            }else if(_less(*b, *a)){
+                risultato._data.push_back(*b);
+                ++b;
+            }else{
+                ++a;
+                ++b;
+            }
+        }
+
+        risultato._data.insert(risultato._data.end(), a, _data.end());
+        risultato._data.insert(risultato._data.end(), b, other._data.end());
+
+        return risultato;
+    }
+
+    /**
+        @brief Restituisce un iteratore costante all'inizio del flat_set
+
+        @return iteratore al primo elemento
+    */
+    const_iterator begin() const{
+        return _data.begin();
+    }
+
+    /**
+        @brief Restituisce un iteratore costante alla fine del flat_set
+
+        @return iteratore alla fine del flat_set
+    */
+    const_iterator end() const{
+        return _data.end();
+    }
+
+    template<typename U, typename C>
+    friend flat_set<U, C> operator+(const flat_set<U, C>&, const flat_set<U, C>&);
+
+    template<typename U, typename C, typename Predicato>
+    friend flat_set<U, C> filter_out(const flat_set<U, C>&, Predicato);
+};
+
+/**
+    @brief Operatore di output per il flat_set
+
+    @tparam T tipo degli elementi del flat_set
+    @tparam C criterio di ordinamento
+    @param os flusso di output
+    @param s flat_set da stampare
+    @return riferimento al flusso di output
+*/
+template<typename T, typename C>
+std::ostream &operator<<(std::ostream &os, const flat_set<T, C> &s){
+    os << "{";
+
+    for(typename flat_set<T, C>::const_iterator it = s.begin(); it != s.end(); ++it){
+        if(it != s.begin())
+            os << ", ";
+        os << *it;
+    }
+
+    os << "}";
+    return os;
+}
+
+/**
+    @brief Operatore di unione tra due flat_set
+
+    Restituisce un nuovo flat_set con tutti gli elementi presenti in almeno
+    uno dei due, calcolato con un merge lineare in O(n+m).
+    L'operatore non modifica i flat_set originali.
+
+    @tparam T tipo degli elementi contenuti nei flat_set
+    @tparam C criterio di ordinamento
+    @param s1 primo flat_set
+    @param s2 secondo flat_set
+    @return nuovo flat_set risultato dell'unione di s1 e s2
+*/
+template<typename T, typename C>
+flat_set<T, C> operator+(const flat_set<T, C>& s1, const flat_set<T, C>& s2){
+    flat_set<T, C> risultato;
+    risultato._data.reserve(s1._data.size() + s2._data.size());
+
+    typename flat_set<T, C>::const_iterator a = s1.begin();
+    typename flat_set<T, C>::const_iterator b = s2.begin();
+
+    while(a != s1.end() && b != s2.end()){
+        if(s1._less(*a, *b)){
+            risultato._data.push_back(*a);
+            ++a;
+        }else if(s1._less(*b, *a)){
+            risultato._data.push_back(*b);
+            ++b;
+        }else{
+            risultato._data.push_back(*a);
+            ++a;
+            ++b;
+        }
+    }
+
+    risultato._data.insert(risultato._data.end(), a, s1.end());
+    risultato._data.insert(risultato._data.end(), b, s2.end());
+
+    return risultato;
+}
+
+/**
+    @brief Filtra gli elementi del flat_set secondo un predicato
+
+    Gli elementi selezionati sono già ordinati, quindi vengono
+    accodati al risultato senza ricerche.
+
+    @tparam T tipo degli elementi
+    @tparam C criterio di ordinamento
+    @tparam Predicato tipo del predicato
+    @param s flat_set di partenza
+    @param P predicato di filtraggio
+    @return nuovo flat_set contenente gli elementi che soddisfano il predicato
+*/
+template<typename T, typename C, typename Predicato>
+flat_set<T, C> filter_out(const flat_set<T, C>& s, Predicato P){
+    flat_set<T, C> risultato;
+
+    for(typename flat_set<T, C>::const_iterator it = s.begin(); it != s.end(); ++it){
+        if(P(*it))
+            risultato._data.push_back(*it);
+    }
+
+    return risultato;
+}
+
+/**
+    @brief Funtore che accoda le Attivita lette in un vettore
+*/
+struct accoda_in_vettore{
+    std::vector<Attivita> *v;
+
+    void operator()(const riga_attivita &r) const{
+        Attivita a = { titolo_attivita(std::string_view(r.titolo, r.lunghezza)), r.ora_inizio, r.ora_fine };
+        v->push_back(std::move(a));
+    }
+};
+
+/**
+    @brief Salva il contenuto di un flat_set di Attivita su file
+
+    Usa lo stesso formato e la stessa scrittura atomica di save() per set<Attivita>.
+
+    @param s flat_set di Attività da salvare
+    @param filename nome del file di output
+    @param atomico true (default) per scrivere su un file temporaneo e poi rinominarlo
+    @throw std::runtime_error se il file non può essere aperto o scritto
+*/
+inline void save(const flat_set<Attivita> &s, const std::string &filename, bool atomico = true){
+    save_attivita(s, filename, atomico);
+}
+
+/**
+    @brief Carica il contenuto di un flat_set di Attività da file
+
+    Le attività lette vengono raccolte e ordinate una sola volta.
+    Se il file non esiste o non è accessibile, la funzione termina
+    lasciando il flat_set invariato.
+
+    @param filename nome del file di input
+    @param s flat_set di Attivita in cui caricare i dati
+    @throw std::runtime_error se una riga del file è malformata
+*/
+inline void load(const std::string &filename, flat_set<Attivita> &s){
+    std::vector<Attivita> lette;
+    accoda_in_vettore accoda = { &lette };
+
+    if(!read_attivita(filename, accoda))
+        return; // se il file non esiste non fa nulla
+
+    flat_set<Attivita> temp(std::make_move_iterator(lette.begin()), std::make_move_iterator(lette.end()));
+    s.swap(temp);
+}
+
+#endif
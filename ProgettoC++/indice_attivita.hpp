@@ -0,0 +1,480 @@
+/**
+    @file indice_attivita.hpp
+
+    @brief Implementazione della classe indice_attivita
+
+    Questo file contiene la classe indice_attivita, un set<Attivita>
+    affiancato da un indice sugli intervalli orari [ora_inizio, ora_fine).
+    L'indice permette di trovare le attività che si sovrappongono a una
+    fascia oraria, quelle in corso a una certa ora e il primo conflitto
+    di una nuova attività senza scorrere tutto il set come filter_out.
+*/
+#ifndef INDICE_ATTIVITA_HPP
+#define INDICE_ATTIVITA_HPP
+
+#include <cstddef> // std::size_t
+#include <vector>
+#include <new> // placement new
+#include <type_traits> // std::is_trivially_destructible
+#include <utility> // std::swap
+#include "set.hpp"
+
+/**
+    @brief Set di Attivita indicizzato per intervallo orario
+
+    Ogni attività occupa l'intervallo semiaperto [ora_inizio, ora_fine):
+    due attività si sovrappongono se una inizia prima che l'altra finisca,
+    quindi 9-11 e 11-12 non sono in conflitto. Le attività con
+    ora_fine <= ora_inizio non occupano tempo: sono nel set ma non
+    compaiono mai nei risultati delle ricerche per intervallo.
+
+    L'indice è un treap (albero binario di ricerca bilanciato con priorità
+    casuali) ordinato per ora di inizio, in cui ogni nodo ricorda la
+    massima ora di fine del proprio sottoalbero. add e remove lo aggiornano
+    in O(log n) atteso, le ricerche costano O(log n + k) per k risultati.
+*/
+class indice_attivita{
+
+    /**
+        @brief Nodo del treap
+
+        Contiene una copia dell'attività: con i titoli internati
+        occupa pochi byte e il nodo è banalmente distruttibile.
+    */
+    struct nodo{
+        Attivita valore;
+        int max_fine; // massima ora_fine nel sottoalbero
+        unsigned int priorita;
+        nodo *sinistro;
+        nodo *destro;
+    };
+
+    set<Attivita> _attivita; // tutte le attività, anche quelle vuote
+    nodo *_radice;
+    pool_allocator<nodo> _alloc;
+    unsigned long long _seme; // stato del generatore delle priorità
+
+    /**
+        @brief Ordine dei nodi: ora di inizio, ora di fine e titolo
+    */
+    static bool precede(const Attivita &a, const Attivita &b){
+        if(a.ora_inizio != b.ora_inizio)
+            return a.ora_inizio < b.ora_inizio;
+        if(a.ora_fine != b.ora_fine)
+            return a.ora_fine < b.ora_fine;
+        return a.titolo.compare(b.titolo) < 0;
+    }
+
+    /**
+        @brief Vero se l'attività occupa un intervallo non vuoto
+    */
+    static bool indicizzata(const Attivita &a){
+        return a.ora_inizio < a.ora_fine;
+    }
+
+    /**
+        @brief Priorità pseudo-casuale per un nuovo nodo (xorshift64)
+    */
+    unsigned int nuova_priorita(){
+        _seme ^= _seme << 13;
+        _seme ^= _seme >> 7;
+        _seme ^= _seme << 17;
+        return static_cast<unsigned int>(_seme >> 32);
+    }
+
+    /**
+        @brief Ricalcola max_fine di un nodo dai figli
+    */
+    static void aggiorna(nodo *n){
+        n->max_fine = n->valore.ora_fine;
+        if(n->sinistro != nullptr && n->sinistro->max_fine > n->max_fine)
+            n->max_fine = n->sinistro->max_fine;
+        if(n->destro != nullptr && n->destro->max_fine > n->max_fine)
+            n->max_fine = n->destro->max_fine;
+    }
+
+    static nodo* ruota_destra(nodo *n){
+        nodo *s = n->sinistro;
+        n->sinistro = s->destro;
+        s->destro = n;
+        aggiorna(n);
+        aggiorna(s);
+        return s;
+    }
+
+    static nodo* ruota_sinistra(nodo *n){
+        nodo *d = n->destro;
+        n->destro = d->sinistro;
+        d->sinistro = n;
+        aggiorna(n);
+        aggiorna(d);
+        return d;
+    }
+
+    /**
+        @brief Distrugge i nodi del sottoalbero di radice n
+
+        La memoria non viene liberata: i nodi sono rilasciati tutti insieme
+        da pool_allocator::release. Se i nodi sono banalmente distruttibili
+        (titoli internati) non c'è nulla da fare e l'albero non viene visitato.
+    */
+    static void distruggi(nodo *n){
+        if(std::is_trivially_destructible<nodo>::value)
+            return;
+
+        while(n != nullptr){
+            distruggi(n->sinistro);
+            nodo *d = n->destro;
+            n->~nodo();
+            n = d;
+        }
+    }
+
+    /**
+        @brief Inserisce un nodo nel sottoalbero di radice n
+
+        @return nuova radice del sottoalbero
+    */
+    static nodo* inserisci(nodo *n, nodo *nuovo){
+        if(n == nullptr)
+            return nuovo;
+
+        if(precede(nuovo->valore, n->valore)){
+            n->sinistro = inserisci(n->sinistro, nuovo);
+            if(n->sinistro->priorita > n->priorita)
+                return ruota_destra(n);
+        }
+        else{
+            n->destro = inserisci(n->destro, nuovo);
+            if(n->destro->priorita > n->priorita)
+                return ruota_sinistra(n);
+        }
+
+        aggiorna(n);
+        return n;
+    }
+
+    /**
+        @brief Unisce due sottoalberi, con tutti i nodi di s prima di quelli di d
+
+        @return radice del sottoalbero unito
+    */
+    static nodo* unisci(nodo *s, nodo *d){
+        if(s == nullptr)
+            return d;
+        if(d == nullptr)
+            return s;
+
+        if(s->priorita > d->priorita){
+            s->destro = unisci(s->destro, d);
+            aggiorna(s);
+            return s;
+        }
+
+        d->sinistro = unisci(s, d->sinistro);
+        aggiorna(d);
+        return d;
+    }
+
+    /**
+        @brief Rimuove un valore dal sottoalbero di radice n
+
+        @return nuova radice del sottoalbero
+    */
+    nodo* rimuovi(nodo *n, const Attivita &value){
+        if(n == nullptr)
+            return nullptr;
+
+        if(precede(value, n->valore))
+            n->sinistro = rimuovi(n->sinistro, value);
+        else if(precede(n->valore, value))
+            n->destro = rimuovi(n->destro, value);
+        else{
+            nodo *r = unisci(n->sinistro, n->destro);
+            n->~nodo();
+            _alloc.deallocate(n, 1);
+            return r;
+        }
+
+        aggiorna(n);
+        return n;
+    }
+
+    /**
+        @brief Visita in ordine di inizio i nodi che si sovrappongono a [a, b)
+
+        Scarta i sottoalberi che finiscono tutti entro a e si ferma
+        al primo nodo che inizia da b in poi.
+
+        @param f funtore chiamato con const Attivita&, restituisce true per fermare la visita
+        @return true se la visita è stata fermata da f
+    */
+    template<typename F>
+    static bool visita(const nodo *n, long long a, long long b, F &f){
+        if(n == nullptr || n->max_fine <= a)
+            return false;
+
+        if(visita(n->sinistro, a, b, f))
+            return true;
+
+        if(n->valore.ora_inizio >= b)
+            return false;
+
+        if(n->valore.ora_fine > a && f(n->valore))
+            return true;
+
+        return visita(n->destro, a, b, f);
+    }
+
+    /**
+        @brief Funtore per visita che chiama f su ogni risultato senza fermarsi
+    */
+    template<typename F>
+    struct chiama_tutti{
+        F &f;
+
+        bool operator()(const Attivita &a){
+            f(a);
+            return false;
+        }
+    };
+
+    /**
+        @brief Funtore per visita che si ferma alla prima attività diversa da esclusa
+    */
+    struct primo_diverso{
+        const Attivita &esclusa;
+        const Attivita *trovata;
+
+        bool operator()(const Attivita &a){
+            if(a == esclusa)
+                return false;
+            trovata = &a;
+            return true;
+        }
+    };
+
+    /**
+        @brief Aggiunge all'indice un'attività già inserita in _attivita
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void indicizza(const Attivita &value){
+        if(!indicizzata(value))
+            return;
+
+        nodo *n = _alloc.allocate(1);
+        try{
+            new (n) nodo{value, value.ora_fine, nuova_priorita(), nullptr, nullptr};
+        }
+        catch(...){
+            _alloc.deallocate(n, 1);
+            throw;
+        }
+        _radice = inserisci(_radice, n);
+    }
+
+    public:
+
+    /**
+        Costruttore di default, indice vuoto
+    */
+    indice_attivita() : _radice(nullptr), _seme(0x9e3779b97f4a7c15ULL) {}
+
+    /**
+        @brief Costruisce l'indice sulle attività di un set
+
+        @param s attività da indicizzare
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    explicit indice_attivita(const set<Attivita> &s) : _radice(nullptr), _seme(0x9e3779b97f4a7c15ULL){
+        _attivita.reserve(s.size());
+        for(set<Attivita>::const_iterator it = s.begin(); it != s.end(); ++it)
+            add(*it);
+    }
+
+    /**
+        Copy constructor, ricostruisce l'indice sulle attività di other
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    indice_attivita(const indice_attivita &other) : _radice(nullptr), _seme(0x9e3779b97f4a7c15ULL){
+        _attivita.reserve(other.size());
+        for(set<Attivita>::const_iterator it = other._attivita.begin(); it != other._attivita.end(); ++it)
+            add(*it);
+    }
+
+    /**
+        Distruttore, distrugge i nodi dell'indice
+    */
+    ~indice_attivita(){
+        distruggi(_radice);
+    }
+
+    /**
+        Operatore di assegnamento
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    indice_attivita& operator=(const indice_attivita &other){
+        if(this != &other){
+            indice_attivita tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    /**
+        @brief Scambia il contenuto di due indici
+    */
+    void swap(indice_attivita &other){
+        _attivita.swap(other._attivita);
+        std::swap(_radice, other._radice);
+        _alloc.swap(other._alloc);
+        std::swap(_seme, other._seme);
+    }
+
+    /**
+        @brief Attività contenute, come set<Attivita>
+    */
+    const set<Attivita>& attivita() const{
+        return _attivita;
+    }
+
+    /**
+        @brief Numero di attività contenute
+    */
+    unsigned int size() const{
+        return _attivita.size();
+    }
+
+    /**
+        @brief Verifica se un'attività è presente
+    */
+    bool contains(const Attivita &value) const{
+        return _attivita.contains(value);
+    }
+
+    /**
+        @brief Inserisce un'attività e la aggiunge all'indice
+
+        Inserisce l'attività solo se non è già presente.
+
+        @param value attività da inserire
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void add(const Attivita &value){
+        if(_attivita.contains(value))
+            return;
+
+        _attivita.add(value);
+        try{
+            indicizza(value);
+        }
+        catch(...){
+            _attivita.remove(value);
+            throw;
+        }
+    }
+
+    /**
+        @brief Rimuove un'attività dal set e dall'indice
+
+        Se l'attività non è presente, l'indice rimane invariato
+
+        @param value attività da rimuovere
+    */
+    void remove(const Attivita &value){
+        if(!_attivita.contains(value))
+            return;
+
+        _attivita.remove(value);
+        if(indicizzata(value))
+            _radice = rimuovi(_radice, value);
+    }
+
+    /**
+        Svuota l'indice
+    */
+    void clear(){
+        _attivita.clear();
+        distruggi(_radice);
+        _radice = nullptr;
+        _alloc.release();
+    }
+
+    /**
+        @brief Chiama f sulle attività che si sovrappongono a [inizio, fine)
+
+        Le attività sono visitate in ordine di ora di inizio.
+
+        @tparam F funtore chiamato con const Attivita&
+        @param inizio inizio della fascia oraria
+        @param fine fine della fascia oraria, esclusa
+        @param f funtore da chiamare
+    */
+    template<typename F>
+    void sovrapposte(int inizio, int fine, F f) const{
+        chiama_tutti<F> c = {f};
+        visita(_radice, inizio, fine, c);
+    }
+
+    /**
+        @brief Attività che si sovrappongono a [inizio, fine)
+
+        @return attività in ordine di ora di inizio
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    std::vector<Attivita> sovrapposte(int inizio, int fine) const{
+        std::vector<Attivita> risultato;
+        sovrapposte(inizio, fine, [&risultato](const Attivita &a){ risultato.push_back(a); });
+        return risultato;
+    }
+
+    /**
+        @brief Chiama f sulle attività in corso all'ora t
+
+        Un'attività è in corso se ora_inizio <= t < ora_fine.
+
+        @tparam F funtore chiamato con const Attivita&
+    */
+    template<typename F>
+    void attive(int t, F f) const{
+        chiama_tutti<F> c = {f};
+        visita(_radice, t, static_cast<long long>(t) + 1, c);
+    }
+
+    /**
+        @brief Attività in corso all'ora t
+
+        @return attività in ordine di ora di inizio
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    std::vector<Attivita> attive(int t) const{
+        std::vector<Attivita> risultato;
+        attive(t, [&risultato](const Attivita &a){ risultato.push_back(a); });
+        return risultato;
+    }
+
+    /**
+        @brief Prima attività in conflitto con una nuova attività
+
+        Cerca, in ordine di ora di inizio, la prima attività che si
+        sovrappone a value. L'attività value stessa, se presente,
+        non è considerata un conflitto.
+
+        @param value attività da controllare
+        @return puntatore all'attività in conflitto, nullptr se non ce ne sono.
+                Resta valido fino alla successiva modifica dell'indice
+    */
+    const Attivita* primo_conflitto(const Attivita &value) const{
+        if(!indicizzata(value))
+            return nullptr;
+
+        primo_diverso p = {value, nullptr};
+        visita(_radice, value.ora_inizio, value.ora_fine, p);
+        return p.trovata;
+    }
+};
+
+#endif
@@ -11,7 +11,21 @@
 #include <iostream>
 #include <cassert>
 #include "set.hpp"
+#include "flat_set.hpp"
+#include "snapshot.hpp"
+#include "thread_pool.hpp"
+#include "set_parallel.hpp"
+#include "concurrent_set.hpp"
+#include "indice_attivita.hpp"
+#include "conta_allocazioni.hpp"
 #include <stdexcept>
+#include <utility> // std::move
+#include <vector>
+#include <sstream> // std::istringstream
+#include <iterator> // std::istream_iterator
+#include <fstream>
+#include <filesystem>
+#include <atomic>
 
 /** 
     @brief Predicato che verifica se un intero è pari
@@ -698,6 +712,1402 @@ void test_tipo_custom(){
     std::cout << "  >>> [OK] Tipo custom Attivita" << std::endl << std::endl;
 }
 
+/* ============================
+   TEST TABELLA HASH
+   ============================ */
+/** 
+    @brief Hash costante, forza tutte le collisioni nella tabella
+*/
+struct HashCostante{
+    std::size_t operator()(int) const{
+        return 42;
+    }
+};
+
+/** 
+    @brief Test della tabella hash interna al set
+
+    Verifica add, contains e remove su molti elementi (con ridimensionamenti
+    della tabella) e con un hash che produce solo collisioni, così da
+    esercitare la cancellazione con spostamento all'indietro.
+*/
+void test_tabella_hash(){
+    std::cout << "[TEST TABELLA HASH]" << std::endl;
+
+    set<int> s;
+    for(int i = 0; i < 10000; ++i)
+        s.add(i);
+    for(int i = 0; i < 10000; ++i)
+        s.add(i);
+
+    std::cout << "  Inseriti 0..9999 due volte, size: " << s.size() << " (expected 10000)" << std::endl;
+    assert(s.size() == 10000);
+
+    for(int i = 0; i < 10000; i += 2)
+        s.remove(i);
+
+    std::cout << "  Rimossi i pari, size: " << s.size() << " (expected 5000)" << std::endl;
+    assert(s.size() == 5000);
+    for(int i = 0; i < 10000; ++i)
+        assert(s.contains(i) == (i % 2 != 0));
+
+    set<int, HashCostante> c;
+    for(int i = 0; i < 100; ++i)
+        c.add(i);
+    for(int i = 0; i < 100; i += 3)
+        c.remove(i);
+    for(int i = 0; i < 100; ++i)
+        assert(c.contains(i) == (i % 3 != 0));
+
+    std::cout << "  Set con sole collisioni, size: " << c.size() << " (expected 66)" << std::endl;
+    assert(c.size() == 66);
+
+    int conta = 0;
+    for(set<int, HashCostante>::const_iterator it = c.begin(); it != c.end(); ++it)
+        ++conta;
+    assert(conta == 66);
+
+    std::cout << "  >>> [OK] tabella hash" << std::endl << std::endl;
+}
+
+/* ============================
+   TEST POOL ALLOCATOR
+   ============================ */
+/** 
+    @brief Test dell'allocatore a blocchi dei nodi
+
+    Verifica che il set funzioni sia con il pool di default sia con
+    std::allocator, che i nodi rimossi vengano riutilizzati e che
+    copia, assegnamento e clear lascino i set indipendenti.
+*/
+void test_pool_allocator(){
+    std::cout << "[TEST POOL ALLOCATOR]" << std::endl;
+
+    pool_allocator<int> pool;
+    int *a = pool.allocate(1);
+    pool.deallocate(a, 1);
+    int *b = pool.allocate(1);
+    std::cout << "  Slot riutilizzato dopo deallocate: " << (a == b) << " (expected 1)" << std::endl;
+    assert(a == b);
+    pool.deallocate(b, 1);
+
+    set<std::string> s;
+    for(int i = 0; i < 1000; ++i)
+        s.add("titolo di una attivita numero " + std::to_string(i));
+
+    set<std::string> copia(s);
+    s.clear();
+    assert(s.size() == 0);
+    assert(copia.size() == 1000);
+    assert(copia.contains("titolo di una attivita numero 999"));
+
+    s.add("dopo il clear");
+    assert(s.size() == 1 && s.contains("dopo il clear"));
+
+    s = copia;
+    copia.clear();
+    assert(s.size() == 1000);
+    assert(s.contains("titolo di una attivita numero 0"));
+
+    set<int, std::hash<int>, std::allocator<int> > n;
+    for(int i = 0; i < 100; ++i)
+        n.add(i);
+    n.remove(50);
+    set<int, std::hash<int>, std::allocator<int> > m(n);
+    assert(m == n && m.size() == 99 && !m.contains(50));
+
+    std::cout << "  Set con std::allocator: " << m.size() << " elementi (expected 99)" << std::endl;
+
+    std::cout << "  >>> [OK] pool allocator" << std::endl << std::endl;
+}
+
+/* ============================
+   TEST FLAT_SET
+   ============================ */
+/** 
+    @brief Test della variante ordinata flat_set
+
+    Verifica ordinamento, assenza di duplicati, ricerca binaria,
+    unione e intersezione per merge, filter_out e save / load.
+*/
+void test_flat_set(){
+    std::cout << "[TEST FLAT_SET]" << std::endl;
+
+    int a[] = {5, 1, 4, 1, 3};
+    flat_set<int> s1(a, a+5);
+    std::cout << "  s1 = " << s1 << " (expected {1, 3, 4, 5})" << std::endl;
+
+    assert(s1.size() == 4);
+    assert(s1[0] == 1 && s1[1] == 3 && s1[2] == 4 && s1[3] == 5);
+
+    s1.add(2);
+    s1.add(2);
+    s1.remove(5);
+    s1.remove(42);
+    assert(s1.size() == 4);
+    assert(s1.contains(2) && !s1.contains(5));
+
+    flat_set<int> s2;
+    s2.add(4);
+    s2.add(6);
+    s2.add(2);
+
+    flat_set<int> u = s1 + s2;
+    flat_set<int> i = s1 - s2;
+    std::cout << "  s1 + " << s2 << " = " << u << std::endl;
+    std::cout << "  s1 - " << s2 << " = " << i << std::endl;
+
+    int attesi_u[] = {1, 2, 3, 4, 6};
+    int attesi_i[] = {2, 4};
+    assert(u == flat_set<int>(attesi_u, attesi_u+5));
+    assert(i == flat_set<int>(attesi_i, attesi_i+2));
+
+    flat_set<int> pari = filter_out(u, IsEven());
+    assert(pari.size() == 3 && pari[0] == 2 && pari[2] == 6);
+
+    try{
+        std::cout << s1[10] << std::endl;
+        assert(false);
+    }catch(const std::out_of_range& e){
+        std::cout << "  [EXCEPTION] out_of_range catturata correttamente" << std::endl;
+    }
+
+    flat_set<Attivita> f;
+    Attivita a1; a1.titolo = "StudioC++"; a1.ora_inizio = 10; a1.ora_fine = 15;
+    Attivita a2; a2.titolo = "Allenamento"; a2.ora_inizio = 18; a2.ora_fine = 20;
+    f.add(a1);
+    f.add(a2);
+    assert(f[0] == a2);
+
+    save(f, "attivita_flat_set.txt");
+    flat_set<Attivita> f2;
+    load("attivita_flat_set.txt", f2);
+    assert(f == f2);
+
+    set<Attivita> s;
+    load("attivita_flat_set.txt", s);
+    assert(s.size() == 2 && s.contains(a1) && s.contains(a2));
+
+    std::cout << "  flat_set<Attivita> dopo save / load: " << f2 << std::endl;
+
+    std::cout << "  >>> [OK] flat_set" << std::endl << std::endl;
+}
+
+/* ============================
+   TEST DIFFERENZA
+   ============================ */
+/** 
+    @brief Test di difference e symmetric_difference
+
+    Verifica la differenza e la differenza simmetrica sia per set sia per flat_set.
+*/
+void test_differenza(){
+    std::cout << "[TEST DIFFERENZA] difference / symmetric_difference" << std::endl;
+
+    int a[] = {1, 2, 3, 4};
+    int b[] = {3, 4, 5};
+    set<int> s1(a, a+4);
+    set<int> s2(b, b+3);
+
+    set<int> d = s1.difference(s2);
+    set<int> sd = s1.symmetric_difference(s2);
+
+    std::cout << "  s1 = " << s1 << ", s2 = " << s2 << std::endl;
+    std::cout << "  s1.difference(s2) = " << d << std::endl;
+    std::cout << "  s1.symmetric_difference(s2) = " << sd << std::endl;
+
+    int attesi_d[] = {1, 2};
+    int attesi_sd[] = {1, 2, 5};
+    assert(d == set<int>(attesi_d, attesi_d+2));
+    assert(sd == set<int>(attesi_sd, attesi_sd+3));
+    assert(s2.difference(s1) == set<int>(attesi_sd+2, attesi_sd+3));
+    assert((s1 - s2) == (s2 - s1));
+
+    flat_set<int> f1(a, a+4);
+    flat_set<int> f2(b, b+3);
+    assert(f1.difference(f2) == flat_set<int>(attesi_d, attesi_d+2));
+    assert(f1.symmetric_difference(f2) == flat_set<int>(attesi_sd, attesi_sd+3));
+
+    std::cout << "  >>> [OK] difference / symmetric_difference" << std::endl << std::endl;
+}
+
+/* ============================
+   TEST MOVE / EMPLACE
+   ============================ */
+/** 
+    @brief Test della semantica di spostamento e di emplace
+
+    Conta le allocazioni per verificare che add(T&&), emplace e lo
+    spostamento dei set non copino i titoli delle attività (abbastanza
+    lunghi da non stare nel buffer interno di std::string). add(const T&)
+    copia il titolo, tranne con i titoli internati, dove le copie di
+    un'Attivita condividono lo stesso testo del pool. Lo stesso controllo
+    è ripetuto su un set<std::string>, il cui contenuto è sempre sullo heap.
+*/
+void test_move_emplace(){
+    std::cout << "[TEST MOVE / EMPLACE]" << std::endl;
+
+    set<Attivita> s;
+    Attivita primo; primo.titolo = "riscaldamento"; primo.ora_inizio = 0; primo.ora_fine = 1;
+    s.add(primo); // alloca il primo blocco del pool e la tabella hash
+
+    Attivita a; a.titolo = "Studio della semantica di spostamento"; a.ora_inizio = 9; a.ora_fine = 11;
+    unsigned long prima = allocazioni;
+    s.add(std::move(a));
+    std::cout << "  add(T&&): " << allocazioni - prima << " allocazioni (expected 0)" << std::endl;
+    assert(allocazioni - prima == 0);
+
+#ifdef ATTIVITA_TITOLI_INTERNATI
+    const unsigned long allocazioni_copia = 0; // titolo condiviso
+#else
+    const unsigned long allocazioni_copia = 1; // copia del titolo
+#endif
+
+    Attivita b; b.titolo = "Attivita copiata perche passata per riferimento"; b.ora_inizio = 12; b.ora_fine = 13;
+    prima = allocazioni;
+    s.add(b);
+    std::cout << "  add(const T&): " << allocazioni - prima << " allocazioni (expected " << allocazioni_copia << ")" << std::endl;
+    assert(allocazioni - prima == allocazioni_copia);
+
+    Attivita c; c.titolo = "Attivita costruita direttamente nel nodo"; c.ora_inizio = 14; c.ora_fine = 16;
+    std::string titolo("Attivita costruita direttamente nel nodo");
+    prima = allocazioni;
+    s.emplace(std::move(titolo), 14, 16);
+    std::cout << "  emplace(titolo, 14, 16): " << allocazioni - prima << " allocazioni (expected 0)" << std::endl;
+    assert(allocazioni - prima == 0);
+
+    assert(s.contains(c));
+    s.emplace(c);
+    assert(s.size() == 4);
+
+    prima = allocazioni;
+    set<Attivita> spostato(std::move(s));
+    std::cout << "  move constructor: " << allocazioni - prima << " allocazioni (expected 0)" << std::endl;
+    assert(allocazioni - prima == 0);
+    assert(spostato.size() == 4 && s.size() == 0);
+    assert(spostato.contains(b) && spostato.contains(c));
+
+    set<Attivita> assegnato;
+    assegnato.add(primo);
+    prima = allocazioni;
+    assegnato = std::move(spostato);
+    std::cout << "  move assignment: " << allocazioni - prima << " allocazioni (expected 0)" << std::endl;
+    assert(allocazioni - prima == 0);
+    assert(assegnato.size() == 4 && spostato.size() == 0);
+
+    spostato.add(b);
+    assert(spostato.size() == 1);
+
+    // payload sempre sullo heap, qualunque sia titolo_attivita:
+    // una stringa più lunga del buffer interno di std::string
+    set<std::string> stringhe;
+    stringhe.add("riscaldamento");
+
+    std::string lunga("Stringa abbastanza lunga da non stare nel buffer interno");
+    prima = allocazioni;
+    stringhe.add(lunga);
+    std::cout << "  set<std::string>::add(const T&): " << allocazioni - prima << " allocazioni (expected 1)" << std::endl;
+    assert(allocazioni - prima == 1);
+    assert(lunga == "Stringa abbastanza lunga da non stare nel buffer interno");
+
+    std::string spostata("Stringa spostata nel nodo senza copiarne il contenuto");
+    const char *testo_spostato = spostata.data();
+    prima = allocazioni;
+    stringhe.add(std::move(spostata));
+    std::cout << "  set<std::string>::add(T&&): " << allocazioni - prima << " allocazioni (expected 0)" << std::endl;
+    assert(allocazioni - prima == 0);
+    assert(stringhe[0].data() == testo_spostato); // ultimo inserito
+
+    std::string argomento("Stringa costruita nel nodo da emplace senza copie");
+    const char *testo_argomento = argomento.data();
+    prima = allocazioni;
+    stringhe.emplace(std::move(argomento));
+    std::cout << "  set<std::string>::emplace(T&&): " << allocazioni - prima << " allocazioni (expected 0)" << std::endl;
+    assert(allocazioni - prima == 0);
+    assert(stringhe[0].data() == testo_argomento);
+    assert(stringhe.size() == 4);
+
+    std::cout << "  >>> [OK] move / emplace" << std::endl << std::endl;
+}
+
+/* ============================
+   TEST CURSORE / BIDIREZIONALE
+   ============================ */
+/** 
+    @brief Test del cursore di operator[] e degli iteratori bidirezionali
+
+    Verifica che l'accesso per indice restituisca gli stessi elementi
+    dell'iterazione anche in ordine sparso e dopo add e remove,
+    e che gli iteratori possano scorrere il set all'indietro partendo da end().
+*/
+void test_cursore_bidirezionale(){
+    std::cout << "[TEST CURSORE / ITERATORE BIDIREZIONALE]" << std::endl;
+
+    set<int> s;
+    for(int i = 0; i < 1000; ++i)
+        s.add(i);
+
+    // accesso sequenziale: stesso ordine dell'iterazione
+    set<int>::const_iterator it = s.begin();
+    for(unsigned int i = 0; i < s.size(); ++i, ++it)
+        assert(s[i] == *it);
+
+    // accesso sparso, in avanti e all'indietro
+    unsigned int indici[] = {500, 3, 998, 499, 501, 0, 999, 250, 251, 750};
+    for(int k = 0; k < 10; ++k)
+        assert(s[indici[k]] == 999 - (int)indici[k]);
+
+    s.add(1000); // inserito in testa, gli indici slittano
+    assert(s[0] == 1000 && s[251] == 749);
+
+    s.remove(749);
+    assert(s[251] == 748 && s.size() == 1000);
+
+    std::cout << "  s[0]: " << s[0] << ", s[251]: " << s[251] << ", s[999]: " << s[999] << std::endl;
+
+    // la versione const non sposta il cursore: più thread possono leggere lo stesso set
+    // e costruire insieme l'indice posizionale
+    const set<int> &cs = s;
+    int primo = cs[0];
+    auto lettore = [&cs, primo]{
+        for(unsigned int i = 0; i < cs.size(); i += 37)
+            assert(cs[i] == *std::next(cs.begin(), i));
+        assert(cs[0] == primo);
+    };
+    std::thread t1(lettore), t2(lettore);
+    t1.join();
+    t2.join();
+
+    // le modifiche scartano l'indice usato dalla versione const
+    s.add(2000);
+    assert(cs[0] == 2000 && cs[1] == primo);
+    s.remove(2000);
+    assert(cs[0] == primo && cs.size() == 1000);
+
+    // scansione completa tramite un riferimento const: O(1) per accesso
+    set<int> grande;
+    long long somma_attesa = 0;
+    for(int i = 0; i < 200000; ++i){
+        grande.add(i);
+        somma_attesa += i;
+    }
+    const set<int> &cg = grande;
+    long long somma = 0;
+    for(unsigned int i = 0; i < cg.size(); ++i)
+        somma += cg[i];
+    assert(somma == somma_attesa && cg[0] == 199999);
+
+    set<int> piccolo;
+    piccolo.add(1);
+    piccolo.add(2);
+    piccolo.add(3);
+
+    std::cout << "  Iterazione all'indietro su " << piccolo << ":";
+    int attesi[] = {1, 2, 3};
+    int k = 0;
+    set<int>::iterator r = piccolo.end();
+    while(r != piccolo.begin()){
+        --r;
+        std::cout << " " << *r;
+        assert(*r == attesi[k++]);
+    }
+    std::cout << std::endl;
+    assert(k == 3);
+
+    set<int>::const_iterator c = piccolo.end();
+    c--;
+    assert(*c == 1);
+    piccolo.remove(1);
+    c = piccolo.end();
+    --c;
+    assert(*c == 2);
+
+    std::cout << "  >>> [OK] cursore / iteratore bidirezionale" << std::endl << std::endl;
+}
+
+/* ============================
+   TEST INSERT_BULK / RESERVE
+   ============================ */
+/** 
+    @brief Test dell'inserimento in blocco
+
+    Verifica reserve e insert_bulk con iteratori forward (vettore con duplicati)
+    e con iteratori di input (flusso), anche su un set non vuoto. Conta le
+    allocazioni per verificare che i duplicati non vengano copiati e che
+    un intervallo lungo con pochi valori distinti non riservi una tabella
+    grande quanto l'intervallo.
+*/
+void test_insert_bulk(){
+    std::cout << "[TEST INSERT_BULK / RESERVE]" << std::endl;
+
+    std::vector<int> v;
+    for(int i = 0; i < 100000; ++i)
+        v.push_back(i % 60000);
+
+    set<int> s;
+    s.add(-1);
+    s.reserve(60001);
+    s.insert_bulk(v.begin(), v.end());
+
+    std::cout << "  100000 valori con duplicati -> size: " << s.size() << " (expected 60001)" << std::endl;
+    assert(s.size() == 60001);
+    assert(s.contains(-1) && s.contains(0) && s.contains(59999) && !s.contains(60000));
+
+    std::istringstream flusso("3 1 4 1 5 9 2 6 5 3 5");
+    set<int> da_flusso;
+    da_flusso.insert_bulk(std::istream_iterator<int>(flusso), std::istream_iterator<int>());
+
+    std::cout << "  Da istream_iterator: " << da_flusso << std::endl;
+    assert(da_flusso.size() == 7);
+
+    // elementi già di tipo T: i duplicati vengono cercati senza essere copiati
+    std::vector<std::string> ripetute(1000, "Stringa ripetuta abbastanza lunga da stare sullo heap");
+    set<std::string> stringhe;
+    stringhe.add(ripetute[0]);
+    stringhe.reserve(2000);
+    unsigned long prima = allocazioni;
+    stringhe.insert_bulk(ripetute.begin(), ripetute.end());
+    std::cout << "  1000 stringhe duplicate: " << allocazioni - prima << " allocazioni (expected 0)" << std::endl;
+    assert(allocazioni - prima == 0);
+    assert(stringhe.size() == 1);
+
+    // la tabella viene riservata per al più 65536 elementi, non per 1000000
+    std::vector<int> pochi_distinti(1000000, 7);
+    set<int> piccolo;
+    unsigned long byte_prima = byte_allocati;
+    piccolo.insert_bulk(pochi_distinti.begin(), pochi_distinti.end());
+    std::cout << "  1000000 valori uguali: " << byte_allocati - byte_prima << " byte allocati" << std::endl;
+    assert(piccolo.size() == 1);
+    assert(byte_allocati - byte_prima < 4 * 65536 * sizeof(void*));
+
+    std::cout << "  >>> [OK] insert_bulk / reserve" << std::endl << std::endl;
+}
+
+/* ============================
+   TEST PARSER DI LOAD
+   ============================ */
+/** 
+    @brief Test del parser a blocchi usato da load
+
+    Verifica righe con '\r\n', righe vuote e spazi attorno ai numeri,
+    file più grandi di un blocco di lettura, righe più lunghe del buffer
+    e la segnalazione delle righe malformate con il loro numero.
+*/
+void test_load_parser(){
+    std::cout << "[TEST PARSER DI LOAD]" << std::endl;
+
+    {
+        std::ofstream f("attivita_parser.txt", std::ios::binary);
+        f << "Studio C++;9;11\r\n\nPalestra; 18 ;20\nCena;20;21";
+    }
+
+    set<Attivita> s;
+    load("attivita_parser.txt", s);
+    std::cout << "  File con \\r\\n, riga vuota e spazi: " << s << std::endl;
+
+    Attivita palestra; palestra.titolo = "Palestra"; palestra.ora_inizio = 18; palestra.ora_fine = 20;
+    Attivita cena; cena.titolo = "Cena"; cena.ora_inizio = 20; cena.ora_fine = 21;
+    assert(s.size() == 3 && s.contains(palestra) && s.contains(cena));
+
+    {
+        std::ofstream f("attivita_parser.txt", std::ios::binary);
+        f << "Studio;9;11\nSenza separatori\nCena;20;21\n";
+    }
+
+    try{
+        load("attivita_parser.txt", s);
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+        assert(std::string(e.what()).find("Riga 2") != std::string::npos);
+    }
+    assert(s.size() == 3); // il set non viene modificato
+
+    {
+        std::ofstream f("attivita_parser.txt", std::ios::binary);
+        f << "Studio;9;11\nCena;20;ventuno\n";
+    }
+
+    try{
+        load("attivita_parser.txt", s);
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+        assert(std::string(e.what()).find("Riga 2") != std::string::npos);
+    }
+
+    set<Attivita> grande;
+    for(int i = 0; i < 100000; ++i)
+        grande.emplace("Attivita numero " + std::to_string(i), i % 24, (i + 1) % 24);
+    std::string lungo(1500000, 'x');
+    grande.emplace(lungo, 1, 2);
+
+    save(grande, "attivita_parser.txt");
+    set<Attivita> riletto;
+    load("attivita_parser.txt", riletto);
+
+    std::cout << "  File di piu' blocchi: " << riletto.size() << " attivita (expected 100001)" << std::endl;
+    assert(riletto == grande);
+
+    std::cout << "  >>> [OK] parser di load" << std::endl << std::endl;
+}
+
+/* ============================
+   TEST SAVE ATOMICO
+   ============================ */
+/** 
+    @brief File temporanei rimasti accanto a filename
+
+    @param filename file di destinazione di un salvataggio
+    @return percorsi dei file "filename.<numero>.tmp" nella cartella corrente
+*/
+std::vector<std::string> temporanei(const std::string &filename){
+    std::vector<std::string> trovati;
+
+    for(const std::filesystem::directory_entry &e : std::filesystem::directory_iterator(".")){
+        std::string nome = e.path().filename().string();
+        if(nome.size() > filename.size() + 4 && nome.compare(0, filename.size() + 1, filename + ".") == 0 &&
+           nome.compare(nome.size() - 4, 4, ".tmp") == 0)
+            trovati.push_back(nome);
+    }
+
+    return trovati;
+}
+
+/** 
+    @brief Test del salvataggio bufferizzato e atomico
+
+    Verifica che save sostituisca il file senza lasciare il temporaneo,
+    che due salvataggi contemporanei sullo stesso file non si ostacolino,
+    che una sostituzione fallita lasci intatti sia la destinazione sia
+    i dati nuovi e che la modalità non atomica scriva direttamente sul file.
+*/
+void test_save_atomico(){
+    std::cout << "[TEST SAVE ATOMICO]" << std::endl;
+
+    set<Attivita> s;
+    s.emplace("Studio", 9, 11);
+    s.emplace("Pranzo", 12, 13);
+    save(s, "attivita_atomico.txt");
+
+    assert(temporanei("attivita_atomico.txt").empty());
+
+    // ogni scrittore ha il proprio temporaneo: vince l'ultimo che chiude
+    {
+        scrittore_attivita primo("attivita_atomico.txt", true);
+        scrittore_attivita secondo("attivita_atomico.txt", true);
+        primo.scrivi("Altro", 5, 1, 2);
+        secondo.scrivi("Studio", 6, 9, 11);
+        secondo.scrivi("Pranzo", 6, 12, 13);
+        primo.chiudi();
+        secondo.chiudi();
+    }
+    assert(temporanei("attivita_atomico.txt").empty());
+
+    set<Attivita> riletto;
+    load("attivita_atomico.txt", riletto);
+    std::cout << "  Dopo due salvataggi contemporanei: " << riletto << std::endl;
+    assert(riletto == s);
+
+    // una cartella al posto del file fa fallire la sostituzione
+    std::filesystem::create_directory("attivita_cartella.txt");
+    std::ofstream("attivita_cartella.txt/dentro.txt") << "x";
+
+    try{
+        save(s, "attivita_cartella.txt");
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+    }
+
+    assert(std::filesystem::is_directory("attivita_cartella.txt"));
+    std::vector<std::string> rimasti = temporanei("attivita_cartella.txt");
+    assert(rimasti.size() == 1);
+
+    load(rimasti[0], riletto);
+    std::cout << "  Dati nel temporaneo dopo la sostituzione fallita: " << riletto << std::endl;
+    assert(riletto == s);
+
+    std::filesystem::remove(rimasti[0]);
+    std::filesystem::remove_all("attivita_cartella.txt");
+
+    set<Attivita> vuoto;
+    save(vuoto, "attivita_atomico.txt", false);
+    load("attivita_atomico.txt", riletto);
+    std::cout << "  Dopo il salvataggio non atomico di un set vuoto: " << riletto << std::endl;
+    assert(riletto.size() == 0);
+
+    std::cout << "  >>> [OK] save atomico" << std::endl << std::endl;
+}
+
+/**
+    @brief Test dello snapshot binario
+
+    Verifica il salvataggio e il caricamento dello snapshot, l'accesso
+    ai record senza copie, il rifiuto di file troncati o corrotti e la
+    conversione tra formato testuale e binario.
+*/
+void test_snapshot(){
+    std::cout << "[TEST SNAPSHOT]" << std::endl;
+
+    set<Attivita> s;
+    s.emplace("Studio", 9, 11);
+    s.emplace("Pranzo", 12, 13);
+    s.emplace("Studio", 15, 17);
+    s.emplace("", 0, 0);
+    save_snapshot(s, "attivita_snapshot.bin");
+
+    {
+        snapshot_view v("attivita_snapshot.bin");
+        std::cout << "  Attivita nello snapshot: " << v.size() << ", titoli distinti: " << v.numero_titoli() << std::endl;
+        assert(v.size() == 4);
+        assert(v.numero_titoli() == 3);
+
+        set<Attivita> dalla_vista;
+        for(std::size_t i = 0; i < v.size(); ++i)
+            dalla_vista.add(v[i].to_attivita());
+        assert(dalla_vista == s);
+
+        try{
+            v[v.size()];
+            assert(false);
+        }catch(const std::out_of_range &e){
+            std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+        }
+    }
+
+    set<Attivita> letto;
+    load_snapshot("attivita_snapshot.bin", letto);
+    std::cout << "  Set caricato: " << letto << std::endl;
+    assert(letto == s);
+
+    // file troncato: il set di destinazione resta invariato
+    std::string contenuto;
+    {
+        std::ifstream in("attivita_snapshot.bin", std::ios::binary);
+        contenuto.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out("attivita_troncato.bin", std::ios::binary);
+        out.write(contenuto.data(), contenuto.size() - 3);
+    }
+    try{
+        load_snapshot("attivita_troncato.bin", letto);
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+    }
+    assert(letto == s);
+
+    // indice di titolo fuori dal range nel primo record: l'apertura non
+    // legge i record, l'errore arriva solo quando il record viene letto
+    std::string corrotto = contenuto;
+    corrotto[sizeof(intestazione_snapshot)] = 100;
+    {
+        std::ofstream out("attivita_troncato.bin", std::ios::binary);
+        out.write(corrotto.data(), corrotto.size());
+    }
+    {
+        snapshot_view v("attivita_troncato.bin");
+        snapshot_view integro("attivita_snapshot.bin");
+        assert(v.size() == 4);
+        assert(v[1].titolo == integro[1].titolo && v[1].ora_inizio == integro[1].ora_inizio);
+        try{
+            v[0];
+            assert(false);
+        }catch(const std::runtime_error &e){
+            std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+        }
+    }
+    try{
+        load_snapshot("attivita_troncato.bin", letto);
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+    }
+    assert(letto == s);
+
+    try{
+        snapshot_view v("file_inesistente.bin");
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+    }
+
+    // conversione testo -> binario -> testo
+    save(s, "attivita_snapshot.txt");
+    text_to_snapshot("attivita_snapshot.txt", "attivita_convertito.bin");
+    snapshot_to_text("attivita_convertito.bin", "attivita_convertito.txt");
+
+    set<Attivita> convertito;
+    load("attivita_convertito.txt", convertito);
+    assert(convertito == s);
+
+    set<Attivita> vuoto;
+    save_snapshot(vuoto, "attivita_snapshot.bin");
+    load_snapshot("attivita_snapshot.bin", letto);
+    assert(letto.size() == 0);
+
+    std::remove("attivita_snapshot.bin");
+    std::remove("attivita_troncato.bin");
+    std::remove("attivita_convertito.bin");
+
+    std::cout << "  >>> [OK] snapshot" << std::endl << std::endl;
+}
+
+/**
+    @brief Filtro per le attività che iniziano di mattina
+*/
+struct di_mattina{
+    bool operator()(const Attivita &a) const{
+        return a.ora_inizio < 12;
+    }
+};
+
+/**
+    @brief Test della lettura a flusso e di load_filtered
+
+    Verifica la lettura riga per riga con lettore_attivita, l'iteratore
+    di input con gli algoritmi standard, load_filtered e la gestione
+    delle righe lunghe e malformate.
+*/
+void test_lettore_attivita(){
+    std::cout << "[TEST LETTORE ATTIVITA]" << std::endl;
+
+    {
+        std::ofstream out("attivita_flusso.txt");
+        out << "Studio;9;11\n\nPranzo;12;13\r\nPalestra;18;20\nColazione;7;8";
+    }
+
+    lettore_attivita lettore("attivita_flusso.txt");
+    assert(lettore.aperto());
+
+    riga_attivita r;
+    assert(lettore.prossima(r));
+    assert(std::string(r.titolo, r.lunghezza) == "Studio");
+    assert(r.ora_inizio == 9 && r.ora_fine == 11);
+    assert(lettore.riga() == 1);
+
+    assert(lettore.prossima(r));
+    assert(std::string(r.titolo, r.lunghezza) == "Pranzo");
+    assert(lettore.riga() == 3); // la riga vuota viene saltata
+
+    // il resto del file con l'iteratore di input
+    lettore_attivita::iterator it = lettore.begin();
+    assert(it->titolo == "Palestra");
+    ++it;
+    assert(it->titolo == "Colazione" && it->ora_fine == 8);
+    ++it;
+    assert(it == lettore.end());
+    assert(!lettore.prossima(r));
+
+    lettore_attivita conta("attivita_flusso.txt");
+    long mattina = std::count_if(conta.begin(), conta.end(), di_mattina());
+    std::cout << "  Attivita di mattina: " << mattina << std::endl;
+    assert(mattina == 2);
+
+    set<Attivita> s;
+    s.emplace("Vecchia", 1, 2);
+    load_filtered("attivita_flusso.txt", s, di_mattina());
+    std::cout << "  load_filtered: " << s << std::endl;
+    assert(s.size() == 2);
+    assert(s.contains(Attivita{"Studio", 9, 11}));
+    assert(s.contains(Attivita{"Colazione", 7, 8}));
+
+    // un file inesistente non modifica il set
+    lettore_attivita inesistente("file_inesistente.txt");
+    assert(!inesistente.aperto());
+    assert(!inesistente.prossima(r));
+    assert(inesistente.begin() == inesistente.end());
+    load_filtered("file_inesistente.txt", s, di_mattina());
+    assert(s.size() == 2);
+
+    // riga più lunga del buffer di lettura
+    std::string lungo(3 << 20, 'x');
+    {
+        std::ofstream out("attivita_flusso.txt");
+        out << "Prima;1;2\n" << lungo << ";3;4\nCorrotta;5\n";
+    }
+
+    lettore_attivita lungo_lettore("attivita_flusso.txt");
+    lettore_attivita::iterator il = lungo_lettore.begin();
+    ++il;
+    assert(il->titolo == lungo && il->ora_fine == 4);
+
+    try{
+        ++il;
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+    }
+
+    try{
+        load_filtered("attivita_flusso.txt", s, di_mattina());
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+    }
+    assert(s.size() == 2);
+
+    std::remove("attivita_flusso.txt");
+
+    std::cout << "  >>> [OK] lettore attivita" << std::endl << std::endl;
+}
+
+/**
+    @brief Verifica che due set contengano gli stessi elementi nello stesso ordine
+*/
+template<typename Set>
+bool stesso_ordine(const Set &a, const Set &b){
+    if(a.size() != b.size())
+        return false;
+
+    typename Set::const_iterator j = b.begin();
+    for(typename Set::const_iterator i = a.begin(); i != a.end(); ++i, ++j){
+        if(!(*i == *j))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+    @brief Test di merge
+
+    Verifica che merge sposti i nodi senza allocare, scarti i duplicati,
+    svuoti il set sorgente e produca lo stesso ordine di add.
+*/
+void test_merge(){
+    std::cout << "[TEST MERGE]" << std::endl;
+
+    set<std::string> a;
+    a.add("uno");
+    a.add("due");
+
+    set<std::string> b;
+    b.add("tre");
+    b.add("due");
+    b.add("quattro");
+
+    set<std::string> atteso;
+    atteso.add("uno");
+    atteso.add("due");
+    atteso.add("tre");
+    atteso.add("due");
+    atteso.add("quattro");
+
+    a.reserve(5);
+    unsigned long prima = allocazioni;
+    a.merge(b);
+    std::cout << "  merge: " << a << ", " << allocazioni - prima << " allocazioni (expected 0)" << std::endl;
+    assert(allocazioni - prima == 0);
+    assert(stesso_ordine(a, atteso));
+    assert(b.size() == 0);
+    assert(b.begin() == b.end());
+
+    // i nodi presi da b restano utilizzabili e il set sorgente è riutilizzabile
+    a.remove("tre");
+    b.add("cinque");
+    assert(a.size() == 3 && b.size() == 1);
+
+    a.merge(a);
+    assert(a.size() == 3);
+
+    // con std::allocator i nodi vengono ricollegati allo stesso modo
+    set<int, std::hash<int>, std::allocator<int> > c;
+    set<int, std::hash<int>, std::allocator<int> > d;
+    for(int i = 0; i < 10; ++i){
+        c.add(i);
+        d.add(i + 5);
+    }
+    c.merge(d);
+    std::cout << "  merge con std::allocator: " << c << std::endl;
+    assert(c.size() == 15 && d.size() == 0);
+    for(int i = 0; i < 15; ++i)
+        assert(c.contains(i));
+
+    std::cout << "  >>> [OK] merge" << std::endl << std::endl;
+}
+
+/**
+    @brief Test del caricamento con più thread
+
+    Confronta load_parallel con load per diversi numeri di thread,
+    compreso l'ordine degli elementi, e verifica che venga segnalata
+    la prima riga malformata del file.
+*/
+void test_load_parallel(){
+    std::cout << "[TEST LOAD PARALLEL]" << std::endl;
+
+    {
+        std::ofstream out("attivita_parallel.txt", std::ios::binary);
+        for(int i = 0; i < 1000; ++i){
+            out << "Attivita " << i % 300 << ";" << i % 24 << ";" << (i % 3) << "\n";
+            if(i % 97 == 0)
+                out << "\r\n";
+        }
+        out << "Ultima;1;2";
+    }
+
+    set<Attivita> sequenziale;
+    load("attivita_parallel.txt", sequenziale);
+    std::cout << "  Attivita distinte: " << sequenziale.size() << std::endl;
+
+    for(unsigned int t = 1; t <= 16; t *= 2){
+        set<Attivita> parallelo;
+        load_parallel("attivita_parallel.txt", parallelo, t);
+        std::cout << "  " << t << " thread: " << parallelo.size() << " attivita" << std::endl;
+        assert(stesso_ordine(parallelo, sequenziale));
+    }
+
+    set<Attivita> automatico;
+    load_parallel("attivita_parallel.txt", automatico);
+    assert(stesso_ordine(automatico, sequenziale));
+
+    // più thread che righe
+    {
+        std::ofstream out("attivita_parallel.txt", std::ios::binary);
+        out << "A;1;2\nB;3;4\nA;1;2\n";
+    }
+    set<Attivita> poche;
+    load_parallel("attivita_parallel.txt", poche, 8);
+    load("attivita_parallel.txt", sequenziale);
+    assert(stesso_ordine(poche, sequenziale));
+
+    {
+        std::ofstream out("attivita_parallel.txt", std::ios::binary);
+    }
+    load_parallel("attivita_parallel.txt", poche, 4);
+    assert(poche.size() == 0);
+
+    // due righe malformate in blocchi diversi: viene segnalata la prima
+    {
+        std::ofstream out("attivita_parallel.txt", std::ios::binary);
+        for(int i = 0; i < 1000; ++i){
+            if(i == 600 || i == 900)
+                out << "Rotta;" << i << "\n";
+            else
+                out << "Attivita " << i << ";1;2\n";
+        }
+    }
+
+    std::string messaggio;
+    try{
+        load("attivita_parallel.txt", sequenziale);
+        assert(false);
+    }catch(const std::runtime_error &e){
+        messaggio = e.what();
+    }
+
+    set<Attivita> invariato;
+    invariato.emplace("Studio", 9, 11);
+    try{
+        load_parallel("attivita_parallel.txt", invariato, 4);
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+        assert(messaggio == e.what());
+    }
+    assert(invariato.size() == 1);
+
+    load_parallel("file_inesistente.txt", invariato, 4);
+    assert(invariato.size() == 1);
+
+    std::remove("attivita_parallel.txt");
+
+    std::cout << "  >>> [OK] load parallel" << std::endl << std::endl;
+}
+
+/**
+    @brief Funtore che somma gli indici dei blocchi, usato da test_thread_pool
+*/
+struct somma_blocchi{
+    std::atomic<long> *somma;
+
+    void operator()(std::size_t i) const{
+        *somma += static_cast<long>(i);
+    }
+};
+
+/**
+    @brief Funtore che fallisce sui blocchi multipli di 3, usato da test_thread_pool
+*/
+struct blocchi_che_falliscono{
+    void operator()(std::size_t i) const{
+        if(i % 3 == 0 && i > 0)
+            throw std::runtime_error("blocco " + std::to_string(i));
+    }
+};
+
+/**
+    @brief Test del pool di thread
+
+    Verifica che il pool esegua tutti i blocchi, che possa essere riusato,
+    che i blocchi possano usare a loro volta il pool e che venga rilanciata
+    l'eccezione del primo blocco che fallisce.
+*/
+void test_thread_pool(){
+    std::cout << "[TEST THREAD POOL]" << std::endl;
+
+    thread_pool pool(4);
+    std::cout << "  Thread nel pool: " << pool.size() << std::endl;
+    assert(pool.size() == 4);
+
+    for(int r = 0; r < 100; ++r){
+        std::atomic<long> somma(0);
+        somma_blocchi f = { &somma };
+        pool.esegui_blocchi(100, f);
+        assert(somma == 4950);
+    }
+
+    // blocchi annidati: ogni blocco usa lo stesso pool
+    std::atomic<long> somma(0);
+    auto esterno = [&](std::size_t){
+        somma_blocchi f = { &somma };
+        pool.esegui_blocchi(10, f);
+    };
+    pool.esegui_blocchi(20, esterno);
+    std::cout << "  Somma dei blocchi annidati: " << somma << std::endl;
+    assert(somma == 20 * 45);
+
+    blocchi_che_falliscono g;
+    try{
+        pool.esegui_blocchi(10, g);
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+        assert(std::string(e.what()) == "blocco 3");
+    }
+
+    pool.esegui_blocchi(0, g);
+
+    std::cout << "  >>> [OK] thread pool" << std::endl << std::endl;
+}
+
+/**
+    @brief Predicato che fallisce sull'elemento 500, usato da test_set_parallel
+*/
+struct fallisce_su_500{
+    bool operator()(int x) const{
+        if(x == 500)
+            throw std::runtime_error("elemento 500");
+        return true;
+    }
+};
+
+/**
+    @brief Test di filter_out, unione e intersezione in parallelo
+
+    Confronta i risultati paralleli con quelli sequenziali,
+    compreso l'ordine degli elementi.
+*/
+void test_set_parallel(){
+    std::cout << "[TEST SET PARALLEL]" << std::endl;
+
+    thread_pool pool(4);
+    politica_parallela par = parallela(pool, 16);
+
+    set<int> a;
+    set<int> b;
+    for(int i = 0; i < 1000; ++i){
+        a.add(i);
+        b.add(i * 3);
+    }
+
+    set<int> pari = filter_out(par, a, IsEven());
+    std::cout << "  filter_out parallela: " << pari.size() << " elementi" << std::endl;
+    assert(stesso_ordine(pari, filter_out(a, IsEven())));
+    assert(stesso_ordine(filter_out(sequenziale, a, IsEven()), filter_out(a, IsEven())));
+
+    set<int> u = unione(par, a, b);
+    std::cout << "  unione parallela: " << u.size() << " elementi" << std::endl;
+    assert(stesso_ordine(u, a + b));
+    assert(stesso_ordine(unione(sequenziale, a, b), a + b));
+
+    set<int> in = intersezione(par, a, b);
+    std::cout << "  intersezione parallela: " << in.size() << " elementi" << std::endl;
+    assert(stesso_ordine(in, a - b));
+    assert(stesso_ordine(intersezione(par, b, a), b - a));
+    assert(stesso_ordine(intersezione(sequenziale, a, b), a - b));
+
+    // set piccoli: un solo blocco
+    set<int> piccolo;
+    piccolo.add(1);
+    piccolo.add(2);
+    assert(stesso_ordine(filter_out(par, piccolo, IsOdd()), filter_out(piccolo, IsOdd())));
+    assert(filter_out(par, set<int>(), IsOdd()).size() == 0);
+
+    // pool globale e tipo con stringhe
+    set<Attivita> attivita;
+    for(int i = 0; i < 5000; ++i)
+        attivita.emplace("Attivita " + std::to_string(i), i % 24, (i + 1) % 24);
+    set<Attivita> mattina = filter_out(parallela(64), attivita, di_mattina());
+    assert(stesso_ordine(mattina, filter_out(attivita, di_mattina())));
+
+    try{
+        filter_out(par, a, fallisce_su_500());
+        assert(false);
+    }catch(const std::runtime_error &e){
+        std::cout << "  [EXCEPTION] " << e.what() << std::endl;
+    }
+
+    std::cout << "  >>> [OK] set parallel" << std::endl << std::endl;
+}
+
+/**
+    @brief Test di concurrent_set
+
+    Più thread inseriscono, cercano e rimuovono elementi in parallelo,
+    mentre un altro thread ne fa copie con snapshot e for_each.
+*/
+void test_concurrent_set(){
+    std::cout << "[TEST CONCURRENT SET]" << std::endl;
+
+    concurrent_set<int> cs(10);
+    std::cout << "  Shard: " << cs.numero_shard() << std::endl;
+    assert(cs.numero_shard() == 16);
+
+    // quattro scrittori con intervalli sovrapposti
+    std::vector<std::thread> scrittori;
+    for(int t = 0; t < 4; ++t){
+        scrittori.push_back(std::thread([&cs, t]{
+            for(int i = t * 500; i < t * 500 + 1000; ++i)
+                cs.add(i);
+        }));
+    }
+
+    // un lettore che fa copie mentre gli scrittori lavorano
+    std::atomic<bool> fermo(false);
+    std::thread lettore([&cs, &fermo]{
+        while(!fermo){
+            set<int> copia = cs.snapshot();
+            for(set<int>::const_iterator it = copia.begin(); it != copia.end(); ++it)
+                assert(*it >= 0 && *it < 2500);
+
+            long n = 0;
+            cs.for_each([&n](int){ ++n; });
+            assert(n <= 2500);
+        }
+    });
+
+    for(std::size_t t = 0; t < scrittori.size(); ++t)
+        scrittori[t].join();
+    fermo = true;
+    lettore.join();
+
+    std::cout << "  Elementi dopo gli inserimenti concorrenti: " << cs.size() << std::endl;
+    assert(cs.size() == 2500);
+    for(int i = 0; i < 2500; ++i)
+        assert(cs.contains(i));
+    assert(!cs.contains(2500));
+
+    // rimozioni concorrenti dei numeri dispari
+    std::vector<std::thread> rimozioni;
+    for(int t = 0; t < 4; ++t){
+        rimozioni.push_back(std::thread([&cs, t]{
+            for(int i = 1 + t * 2; i < 2500; i += 8)
+                cs.remove(i);
+        }));
+    }
+    for(std::size_t t = 0; t < rimozioni.size(); ++t)
+        rimozioni[t].join();
+
+    set<int> copia = cs.snapshot();
+    assert(copia.size() == 1250);
+    assert(copia == filter_out(copia, IsEven()));
+
+    concurrent_set<Attivita> ca;
+    ca.emplace("Studio", 9, 11);
+    ca.add(Attivita{"Pranzo", 12, 13});
+    ca.emplace("Studio", 9, 11);
+    std::cout << "  Attivita: " << ca.snapshot() << std::endl;
+    assert(ca.size() == 2);
+    assert(ca.contains(Attivita{"Studio", 9, 11}));
+
+    ca.clear();
+    assert(ca.size() == 0);
+
+    std::cout << "  >>> [OK] concurrent set" << std::endl << std::endl;
+}
+
+/**
+    @brief Test dei titoli internati
+
+    Verifica che titoli con lo stesso testo condividano la stessa copia,
+    che confronti, ordinamento e hash siano coerenti con le stringhe,
+    che l'internamento sia sicuro tra thread e che save e load
+    mantengano il formato di testo.
+*/
+void test_titolo_internato(){
+    std::cout << "[TEST TITOLO INTERNATO]" << std::endl;
+
+#ifdef ATTIVITA_TITOLI_INTERNATI
+    std::cout << "  sizeof(Attivita): " << sizeof(Attivita) << " byte" << std::endl;
+    assert(sizeof(Attivita) == sizeof(void*) + 2 * sizeof(int));
+#endif
+    std::cout << "  sizeof(titolo_internato): " << sizeof(titolo_internato) << " byte" << std::endl;
+    assert(sizeof(titolo_internato) == sizeof(void*));
+
+    titolo_internato a("Riunione di progetto settimanale");
+    titolo_internato b(std::string("Riunione di progetto settimanale"));
+    titolo_internato c("Pranzo");
+    titolo_internato vuoto;
+
+    assert(a == b);
+    assert(a.data() == b.data()); // stessa copia del testo
+    assert(a != c);
+    assert(a == "Riunione di progetto settimanale");
+    assert(std::string("Pranzo") == c);
+    assert(vuoto.empty() && vuoto == "");
+    assert(a.hash() == b.hash());
+    assert(std::hash<titolo_internato>()(a) == std::hash<titolo_internato>()(b));
+
+    // l'ordinamento segue quello delle stringhe
+    assert(c.compare(a) < 0 && a.compare(c) > 0 && a.compare(b) == 0);
+    const std::string &testo = a;
+    assert(testo == "Riunione di progetto settimanale");
+
+    // confrontare con una stringa non aggiunge titoli al pool
+    std::size_t titoli = titolo_internato::numero_titoli();
+    assert(!(c == "Titolo mai usato prima"));
+    assert(titolo_internato::numero_titoli() == titoli);
+
+    // più thread che internano gli stessi titoli ottengono la stessa copia
+    std::vector<const char*> risultati(8);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 8; ++t){
+        threads.push_back(std::thread([&risultati, t]{
+            for(int i = 0; i < 200; ++i)
+                titolo_internato("Titolo concorrente " + std::to_string(i));
+            risultati[t] = titolo_internato("Titolo concorrente 7").data();
+        }));
+    }
+    for(std::size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+    for(std::size_t t = 1; t < risultati.size(); ++t)
+        assert(risultati[t] == risultati[0]);
+    std::cout << "  Titoli nel pool: " << titolo_internato::numero_titoli() << std::endl;
+    assert(titolo_internato::numero_titoli() == titoli + 200);
+
+    // save e load mantengono il formato di testo
+    set<Attivita> s;
+    s.emplace("Riunione di progetto settimanale", 9, 10);
+    s.emplace("Riunione di progetto settimanale", 15, 16);
+    s.emplace("Pranzo", 12, 13);
+    save(s, "attivita_titoli.txt");
+
+    std::ifstream in("attivita_titoli.txt");
+    std::string riga;
+    std::getline(in, riga);
+    std::cout << "  Prima riga del file: " << riga << std::endl;
+    assert(riga == "Pranzo;12;13");
+    in.close();
+
+    set<Attivita> letto;
+    load("attivita_titoli.txt", letto);
+    assert(letto == s);
+#ifdef ATTIVITA_TITOLI_INTERNATI
+    assert(letto[letto.size() - 1].titolo.data() == c.data()); // prima riga del file
+#endif
+
+    std::remove("attivita_titoli.txt");
+
+    std::cout << "  >>> [OK] titolo internato" << std::endl << std::endl;
+}
+
+/**
+    @brief Test dell'indice sugli intervalli orari
+
+    Confronta le ricerche di indice_attivita con una scansione completa
+    del set, anche dopo una serie di inserimenti e rimozioni.
+*/
+void test_indice_attivita(){
+    std::cout << "[TEST INDICE ATTIVITA]" << std::endl;
+
+    indice_attivita idx;
+    idx.add(Attivita{"Colazione", 7, 8});
+    idx.add(Attivita{"Studio", 9, 11});
+    idx.add(Attivita{"Lezione", 10, 12});
+    idx.add(Attivita{"Pranzo", 12, 13});
+    idx.add(Attivita{"Promemoria", 15, 15}); // intervallo vuoto
+    idx.add(Attivita{"Studio", 9, 11}); // duplicato
+
+    std::cout << "  Attivita: " << idx.attivita() << std::endl;
+    assert(idx.size() == 5);
+    assert(idx.contains(Attivita{"Promemoria", 15, 15}));
+
+    std::vector<Attivita> r = idx.sovrapposte(10, 12);
+    assert(r.size() == 2);
+    assert(r[0] == (Attivita{"Studio", 9, 11}) && r[1] == (Attivita{"Lezione", 10, 12}));
+
+    // gli estremi sono esclusi: 11-12 tocca Studio ma non si sovrappone
+    r = idx.attive(11);
+    assert(r.size() == 1 && r[0] == (Attivita{"Lezione", 10, 12}));
+    assert(idx.attive(8).empty());
+    assert(idx.sovrapposte(14, 16).empty());
+
+    const Attivita *c = idx.primo_conflitto(Attivita{"Riunione", 8, 10});
+    assert(c != nullptr && *c == (Attivita{"Studio", 9, 11}));
+    std::cout << "  Primo conflitto per Riunione 8-10: " << *c << std::endl;
+    assert(idx.primo_conflitto(Attivita{"Riunione", 13, 15}) == nullptr);
+    // un'attività già presente non è in conflitto con se stessa
+    c = idx.primo_conflitto(Attivita{"Pranzo", 12, 13});
+    assert(c == nullptr);
+
+    idx.remove(Attivita{"Studio", 9, 11});
+    idx.remove(Attivita{"Studio", 9, 11});
+    assert(idx.size() == 4);
+    assert(idx.attive(9).empty());
+
+    // confronto con la scansione completa su dati casuali
+    indice_attivita grande;
+    set<Attivita> riferimento;
+    unsigned int seme = 12345;
+    for(int i = 0; i < 3000; ++i){
+        seme = seme * 1103515245u + 12345u;
+        int inizio = static_cast<int>((seme >> 8) % 1440);
+        int durata = static_cast<int>((seme >> 20) % 120);
+        Attivita a = {"Attivita " + std::to_string(i % 50), inizio, inizio + durata};
+
+        if(i % 4 == 3 && riferimento.size() > 0){
+            Attivita vecchia = riferimento[(seme >> 4) % riferimento.size()];
+            grande.remove(vecchia);
+            riferimento.remove(vecchia);
+        }
+        grande.add(a);
+        riferimento.add(a);
+    }
+    assert(grande.attivita() == riferimento);
+
+    for(int inizio = 0; inizio < 1500; inizio += 37){
+        int fine = inizio + 45;
+        set<Attivita> attese;
+        for(set<Attivita>::const_iterator it = riferimento.begin(); it != riferimento.end(); ++it){
+            if(it->ora_inizio < fine && it->ora_fine > inizio && it->ora_inizio < it->ora_fine)
+                attese.add(*it);
+        }
+
+        std::vector<Attivita> trovate = grande.sovrapposte(inizio, fine);
+        for(std::size_t i = 1; i < trovate.size(); ++i)
+            assert(trovate[i - 1].ora_inizio <= trovate[i].ora_inizio);
+        assert(set<Attivita>(trovate.begin(), trovate.end()) == attese);
+
+        const Attivita *primo = grande.primo_conflitto(Attivita{"Nuova", inizio, fine});
+        assert((primo == nullptr) == (attese.size() == 0));
+        if(primo != nullptr)
+            assert(primo->ora_inizio == trovate[0].ora_inizio);
+    }
+
+    indice_attivita copia(grande);
+    assert(copia.sovrapposte(0, 2000).size() == grande.sovrapposte(0, 2000).size());
+    copia.clear();
+    assert(copia.size() == 0 && copia.attive(100).empty());
+    assert(grande.size() == riferimento.size());
+
+    std::cout << "  Attivita casuali indicizzate: " << grande.size() << std::endl;
+    std::cout << "  >>> [OK] indice attivita" << std::endl << std::endl;
+}
+
 /** 
     @brief Funzione principale di test
 
@@ -746,6 +2156,43 @@ int main() {
 
     test_tipo_custom();
 
+    test_tabella_hash();
+
+    test_pool_allocator();
+
+    test_flat_set();
+
+    test_differenza();
+
+    test_move_emplace();
+
+    test_cursore_bidirezionale();
+
+    test_insert_bulk();
+
+    test_load_parser();
+
+    test_save_atomico();
+
+    test_snapshot();
+
+    test_lettore_attivita();
+
+    test_merge();
+
+    test_load_parallel();
+
+    test_thread_pool();
+
+    test_set_parallel();
+
+    test_concurrent_set();
+
+    test_titolo_internato();
+
+
+    test_indice_attivita();
+
     std::cout << " *** TUTTI I TEST PASSATI CORRETTAMENTE ***" << std::endl << std::endl;
 
     return 0;
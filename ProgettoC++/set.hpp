@@ -18,6 +18,53 @@
 #include <fstream>
 #include <iterator> // std::forward_iterator_tag
 #include <cstddef>  // std::ptrdiff_t
+#include <functional> // std::hash
+#include <memory> // std::allocator_traits
+#include <utility> // std::swap
+#include <type_traits> // std::is_trivially_destructible
+#include <vector>
+#include <cstring> // std::memchr, std::memmove, std::memcpy
+#include <cstdio> // std::rename, std::remove
+#include <atomic>
+#include <chrono>
+#include <random> // std::random_device
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h> // MoveFileExA, FlushFileBuffers
+#else
+#include <fcntl.h> // open
+#include <unistd.h> // fsync, close
+#include <cerrno> // errno, EINVAL
+#endif
+#include <charconv> // std::from_chars, std::to_chars
+#include <system_error> // std::errc
+#include <thread>
+#include <exception> // std::exception_ptr
+#include <string_view>
+#include "titolo.hpp"
+
+/** 
+    @brief Tipo del titolo delle Attivita
+
+    Per default è una std::string. Se è definito ATTIVITA_TITOLI_INTERNATI
+    il titolo è un titolo_internato: attività con lo stesso titolo ne
+    condividono il testo, e confronti e hash non leggono il testo.
+    Conviene quando molte attività hanno pochi titoli diversi; con titoli
+    quasi tutti diversi il caricamento è più lento, perché ogni titolo
+    viene cercato e copiato nel pool, e la memoria del pool non viene
+    mai restituita. La macro va definita allo stesso modo in tutte le
+    unità di traduzione del programma.
+*/
+#ifdef ATTIVITA_TITOLI_INTERNATI
+typedef titolo_internato titolo_attivita;
+#else
+typedef std::string titolo_attivita;
+#endif
 
 /** 
     @brief Struttura che rappresenta un'attività
@@ -26,7 +73,7 @@
     come il titolo e l'orario di inizio e fine. 
 */
 struct Attivita{
-    std::string titolo;
+    titolo_attivita titolo;
     int ora_inizio;
     int ora_fine;
 };
@@ -41,12 +88,31 @@ struct Attivita{
     @param b seconda attività
     @return true se le due attvità sono uguali, false altrimenti
 */
-bool operator==(const Attivita &a, const Attivita &b){
+inline bool operator==(const Attivita &a, const Attivita &b){
     return a.titolo == b.titolo &&
            a.ora_inizio == b.ora_inizio &&
            a.ora_fine == b.ora_fine;
 }
 
+/** 
+    @brief Operatore di ordinamento tra due Attività
+
+    Ordina le attività per titolo, poi per ora di inizio e infine
+    per ora di fine. È coerente con l'operatore di uguaglianza.
+
+    @param a prima attività
+    @param b seconda attività
+    @return true se a precede b, false altrimenti
+*/
+inline bool operator<(const Attivita &a, const Attivita &b){
+    int c = a.titolo.compare(b.titolo);
+    if(c != 0)
+        return c < 0;
+    if(a.ora_inizio != b.ora_inizio)
+        return a.ora_inizio < b.ora_inizio;
+    return a.ora_fine < b.ora_fine;
+}
+
 /** 
     @brief Operatore di output per Attività
 
@@ -57,344 +123,1207 @@ bool operator==(const Attivita &a, const Attivita &b){
     @param a attvità da stampare
     @return riferimento al flusso di output
 */
-std::ostream& operator<<(std::ostream& os, const Attivita &a){
+inline std::ostream& operator<<(std::ostream& os, const Attivita &a){
     os << a.titolo << " "
        << a.ora_inizio << "-"
        << a.ora_fine;
     return os;
 }
 
+namespace std{
+
+    /**
+        @brief Specializzazione di std::hash per Attività
+
+        Combina gli hash del titolo, dell'ora di inizio e dell'ora di fine,
+        coerentemente con l'operatore di uguaglianza: due attività uguali
+        hanno lo stesso hash. Con i titoli internati l'hash del titolo
+        non legge il testo.
+    */
+    template<>
+    struct hash<Attivita>{
+        std::size_t operator()(const Attivita &a) const{
+            std::size_t h = std::hash<titolo_attivita>()(a.titolo);
+            h ^= std::hash<int>()(a.ora_inizio) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            h ^= std::hash<int>()(a.ora_fine) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+}
+
 /** 
-    @brief Classe set templata
+    @brief Allocatore a blocchi (arena) per i nodi del set
 
-    Rappresenta un insieme di elementi unici di tipo T.
+    Distribuisce oggetti di tipo T prelevandoli da grandi blocchi contigui
+    di memoria, invece di eseguire una new per ogni oggetto. Gli oggetti
+    restituiti con deallocate vengono riutilizzati tramite una free list,
+    mentre la memoria dei blocchi viene liberata tutta insieme con release()
+    o alla distruzione dell'allocatore.
 
-    @tparam T tipo degli elementi contenuti nel set
+    Ogni istanza possiede il proprio pool: la copia di un allocatore
+    parte con un pool vuoto, mentre lo spostamento e lo swap trasferiscono
+    i blocchi.
+
+    @note pool_allocator è pensato solo per i nodi di set e indice_attivita
+    e non soddisfa i requisiti Allocator della libreria standard: una copia
+    non può liberare la memoria dell'originale (a != A(a)). Per questo non
+    ha operator== e operator!=, così il suo uso con i contenitori standard
+    che confrontano gli allocatori non compila.
+
+    @tparam T tipo degli oggetti allocati
 */
 template<typename T>
-class set{
+class pool_allocator{
 
     /** 
-        @brief Struttura dati node
+        @brief Slot di un blocco
 
-        Struttura dati node interna che viene usata per creare il set. 
-        Implementazione come una lista ma non ordinata. 
+        Contiene un oggetto T oppure, se libero, il puntatore
+        al prossimo slot libero. Il primo slot di ogni blocco è usato
+        per collegare i blocchi tra loro.
     */
-    struct node{
-        T value; // dato di un elemento del set
-        node *next; // puntatore al nodo successivo del set
-
-        /** 
-            Costrutture di default
-            @post next == nullptr
-        */
-        node() : next(nullptr){}
+    union slot{
+        slot *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
 
-        /** 
-            Costruttore secondario
-            @param v valore da copiare
+    slot *_blocks; // lista dei blocchi allocati
+    slot *_free; // lista degli slot restituiti con deallocate
+    slot *_next; // prossimo slot mai usato del blocco corrente
+    slot *_end; // fine del blocco corrente
+    std::size_t _block_size; // numero di slot del prossimo blocco
 
-            @post value == v
-            @post next == nullptr
-        */
-        node(const T &v) : value(v), next(nullptr){}
+    static const std::size_t min_block = 64; // slot del primo blocco
+    static const std::size_t max_block = 65536; // slot massimi per blocco
 
-        /** 
-            Costrutture secondario  
-            @param v valore da copiare
-            @param n puntatore al prossimo nodo
+    /** 
+        @brief Alloca un nuovo blocco e lo rende blocco corrente
 
-            @post value == v
-            @post next == n
-        */
-       node(const T &v, node *n) : value(v), next(n){}
-    }; // fine struct node
+        La dimensione dei blocchi raddoppia ad ogni allocazione
+        fino a max_block slot.
 
-    node *_head ;// puntatore all'inizio del set
-    unsigned int _size; // dimensione del set
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void new_block(){
+        slot *b = new slot[_block_size];
+        b[0].next = _blocks;
+        _blocks = b;
+        _next = b + 1;
+        _end = b + _block_size;
+
+        if(_block_size < max_block)
+            _block_size *= 2;
+    }
 
     public:
 
-    /** 
-        Costruttore di default
+    typedef T value_type;
 
-        @post _head == nullptr
-        @post _size == 0
+    template<typename U>
+    struct rebind{
+        typedef pool_allocator<U> other;
+    };
+
+    /** 
+        Costruttore di default, il pool è vuoto
     */
-    set() : _head(nullptr), _size(0) {}
+    pool_allocator() : _blocks(nullptr), _free(nullptr), _next(nullptr),
+                       _end(nullptr), _block_size(min_block) {}
 
     /** 
-        Copy constructor
-        
-        @param other set da copiare
+        Copy constructor, la copia parte con un pool vuoto
+    */
+    pool_allocator(const pool_allocator &) : _blocks(nullptr), _free(nullptr), _next(nullptr),
+                                             _end(nullptr), _block_size(min_block) {}
 
-        @throw std::bad_alloc possibie eccezione di allocazione
+    /** 
+        Costruttore di conversione, il nuovo allocatore parte con un pool vuoto
     */
-    set(const set &other) : _head(nullptr), _size(0){
-        node *curr = other._head;
+    template<typename U>
+    pool_allocator(const pool_allocator<U> &) : _blocks(nullptr), _free(nullptr), _next(nullptr),
+                                                _end(nullptr), _block_size(min_block) {}
 
-        try
-        {
-           while(curr != nullptr){
-                add(curr->value);
-                curr = curr->next;
-           }
-        }
-        catch(...)
-        {
-            clear();
-            throw;
-        }
+    /** 
+        Move constructor, trasferisce i blocchi di other
+
+        @post other non possiede più blocchi
+    */
+    pool_allocator(pool_allocator &&other) noexcept : _blocks(nullptr), _free(nullptr), _next(nullptr),
+                                             _end(nullptr), _block_size(min_block) {
+        swap(other);
     }
 
     /** 
-        Operatore di assegnamento
+        Operatore di assegnamento, l'allocatore mantiene il proprio pool
+    */
+    pool_allocator& operator=(const pool_allocator &){
+        return *this;
+    }
 
-        @param other set da copiare
-        @return reference al set this
-        @throw std::bad_alloc possibile eccezione di allocazione
-     
+    /** 
+        Operatore di assegnamento per spostamento, libera i blocchi
+        correnti e prende quelli di other
     */
-    set& operator=(const set &other){
+    pool_allocator& operator=(pool_allocator &&other) noexcept{
         if(this != &other){
-            set temp(other);
-            this->swap(temp);
+            release();
+            swap(other);
         }
         return *this;
     }
 
     /** 
-        Distruttore, svuota il set
-
-        @post _head == nullptr
-        @post _size == 0;
+        Distruttore, libera tutti i blocchi
     */
-    ~set(){
-       clear();
+    ~pool_allocator(){
+        release();
     }
 
     /** 
-        Svuota il set
+        @brief Alloca spazio per n oggetti
 
-        @post _head == nullptr
-        @post _size == 0;
+        Le richieste di un solo oggetto sono servite dal pool, le altre
+        sono inoltrate all'operatore new globale.
+
+        @param n numero di oggetti
+        @return puntatore alla memoria non inizializzata
+        @throw std::bad_alloc possibile eccezione di allocazione
     */
-    void clear(){
-       node *curr = _head;
-       while(curr != nullptr){
-        node *tmp = curr->next;
-        delete curr;
-        curr = tmp;
-       }
+    T* allocate(std::size_t n){
+        if(n != 1)
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+
+        if(_free != nullptr){
+            slot *s = _free;
+            _free = s->next;
+            return reinterpret_cast<T*>(s->storage);
+        }
 
-       _size = 0;
-       _head = nullptr;
+        if(_next == _end)
+            new_block();
+
+        return reinterpret_cast<T*>((_next++)->storage);
     }
 
     /** 
-        Funzione di swap che scambia il set corrente con quello passato come parametro
-
-        @param other set da scambiare
-    */
-    void swap(set &other){
-        std::swap(_head, other._head);
-        std::swap(_size, other._size);
-   }
+        @brief Restituisce la memoria di n oggetti
 
-    /** 
-        @brief Verifica se un valore è presente nel set
+        Gli slot del pool vengono messi nella free list e riutilizzati,
+        la memoria dei blocchi viene liberata solo da release().
 
-        @param p valore da cercare
-        @return treu se il valore è presente, false altrimenti
+        @param p puntatore ottenuto da allocate
+        @param n numero di oggetti
     */
-    bool contains(const T &p) const{
-        node *curr = _head;
-        while(curr != nullptr){
-            if(curr->value == p)
-                return true;
-            curr = curr->next;
+    void deallocate(T *p, std::size_t n){
+        if(n != 1){
+            ::operator delete(p);
+            return;
         }
 
-        return false;
+        slot *s = reinterpret_cast<slot*>(p);
+        s->next = _free;
+        _free = s;
     }
+
     /** 
-        @brief Ritorna la dimensione del set
+        @brief Libera in un colpo solo tutti i blocchi del pool
 
-        @return _size
+        @pre nessun oggetto allocato dal pool è ancora in uso
     */
-    unsigned int size() const{
-        return _size;
+    void release(){
+        while(_blocks != nullptr){
+            slot *tmp = _blocks[0].next;
+            delete[] _blocks;
+            _blocks = tmp;
+        }
+
+        _free = nullptr;
+        _next = nullptr;
+        _end = nullptr;
+        _block_size = min_block;
     }
 
     /** 
-        @brief Inserisce un valore nel set
+        @brief Prende possesso di tutti i blocchi di un altro pool
 
-        Inserisce il valore solo se non è già presente.
+        Gli oggetti allocati da other restano validi e da questo momento
+        vanno restituiti a questo allocatore. Gli slot liberi di other
+        vengono aggiunti alla free list, quelli mai usati del suo blocco
+        corrente vengono abbandonati.
 
-        @param value valore da inserire
+        @param other allocatore da cui prendere i blocchi
+        @post other non possiede più blocchi
     */
-    void add(const T &value){
-
-        // se già presente, non fare nulla
-        if(contains(value))
+    void adopt(pool_allocator &other){
+        if(this == &other || other._blocks == nullptr)
             return;
 
-        node *n = new node(value);
-
-        // inserimento in testa
-        n->next = _head;
-        _head = n;
+        slot *ultimo = other._blocks;
+        while(ultimo[0].next != nullptr)
+            ultimo = ultimo[0].next;
+        ultimo[0].next = _blocks;
+        _blocks = other._blocks;
+
+        if(other._free != nullptr){
+            slot *s = other._free;
+            while(s->next != nullptr)
+                s = s->next;
+            s->next = _free;
+            _free = other._free;
+        }
 
-        ++_size;
+        other._blocks = nullptr;
+        other._free = nullptr;
+        other._next = nullptr;
+        other._end = nullptr;
+        other._block_size = min_block;
     }
 
     /** 
-        @brief Rimuove un valore dal set
+        Funzione di swap che scambia i pool dei due allocatori
 
-        Se il valore non è presente, il set rimane invariato
-
-        @param value valore da rimuovere
+        @param other allocatore da scambiare
     */
-    void remove(const T &value){
-
-        // caso lista vuota
-        if(_head == nullptr)
-            return;
+    void swap(pool_allocator &other){
+        std::swap(_blocks, other._blocks);
+        std::swap(_free, other._free);
+        std::swap(_next, other._next);
+        std::swap(_end, other._end);
+        std::swap(_block_size, other._block_size);
+    }
 
-        // caso elemento in testa
-        if(_head->value == value){
-            node *tmp = _head;
-            _head = _head->next;
-            delete tmp;
-            --_size;
-            return;
-        }
-           
-        // caso generale
-        node *curr = _head;
-        while(curr->next != nullptr){
-            if(curr->next->value == value){
-                node *tmp = curr->next;
-                curr->next = tmp->next;
-                delete tmp;
-                --_size;
-                return;
-            }
-            
-            curr = curr->next;
-        }
+    friend void swap(pool_allocator &a, pool_allocator &b){
+        a.swap(b);
     }
+};
 
-    /** 
-        @brief Operatore di uguaglianza tra due set
+/** 
+    @brief Indica se un allocatore libera la memoria a blocchi
 
-        Due set sono considerati uguali se contengono
-        gli stessi elementi indipendentemente dall'ordine. 
+    Per gli allocatori generici ogni nodo deve essere restituito
+    singolarmente con deallocate.
 
-        @param other set da confrontare con l'oggetto corrente
-        @return true se i due set contengono gli stessi elementi, false altrimenti
+    @tparam A tipo dell'allocatore
+*/
+template<typename A>
+struct pool_traits{
+    static const bool releases_blocks = false;
+
+    static void release(A &){}
+
+    /** 
+        @brief Prepara a restituire ad a la memoria allocata da other
+
+        @return true se i nodi di other possono essere restituiti ad a
     */
-    bool operator==(const set &other) const{
+    static bool adopt(A &a, A &other){
+        return a == other;
+    }
+};
 
-        if(this->_size != other._size)
-            return false;
+/** 
+    @brief Specializzazione per pool_allocator
 
-        node *curr = _head;
-        while(curr != nullptr){
-            if(!other.contains(curr->value))
-                return false;
-            curr = curr->next;
-        }
+    Il pool libera tutti i nodi in un colpo solo con release().
+*/
+template<typename U>
+struct pool_traits<pool_allocator<U> >{
+    static const bool releases_blocks = true;
 
-        return true;
+    static void release(pool_allocator<U> &a){
+        a.release();
     }
 
-    /** 
-        @brief Operatore di accesso in lettura
+    static bool adopt(pool_allocator<U> &a, pool_allocator<U> &other){
+        a.adopt(other);
+        return true;
+    }
+};
 
-        @param i indice dell'elemento
-        @return riferimento costante all'elemento
-        @throw std::out_of_range se l'indice non è valido
-    */
-    const T& operator[](unsigned int i) const{
+/** 
+    @brief Classe set templata
 
-        if(i >= _size)
-            throw std::out_of_range("Indice fuori dal range");
+    Rappresenta un insieme di elementi unici di tipo T.
 
-        node *curr = _head;
-        unsigned int index = 0;
+    Gli elementi sono memorizzati in una lista doppiamente concatenata,
+    usata per l'iterazione e per operator[], affiancata da una tabella hash
+    ad indirizzamento aperto (probing lineare) che contiene i puntatori
+    ai nodi. La tabella permette di eseguire add, contains e remove
+    in tempo costante ammortizzato.
 
-        while(curr != nullptr){
-            if(index == i)
-                return curr->value;
-            
-                curr = curr->next;
-                ++index;
-        }
+    @note modificare un elemento tramite iterator o operator[] in modo
+    da cambiarne l'hash rende il set inconsistente.
 
-        throw std::out_of_range("Indice fuori dal range");
-    }
+    @tparam T tipo degli elementi contenuti nel set
+    @tparam Hash funtore di hashing per T (default std::hash<T>)
+    @tparam Alloc allocatore usato per i nodi (default pool_allocator<T>)
+*/
+template<typename T, typename Hash = std::hash<T>, typename Alloc = pool_allocator<T> >
+class set{
 
     /** 
-        @brief Operatore di accesso in lettura e scrittura 
+        @brief Struttura dati node
 
-        @param i indice dell'elemento
-        @return riferimento costante all'elemento
-        @throw std::out_of_range se l'indice non è valido
+        Struttura dati node interna che viene usata per creare il set. 
+        Implementazione come una lista ma non ordinata. 
     */
-    T& operator[](unsigned int i){
+    struct node{
+        T value; // dato di un elemento del set
+        node *next; // puntatore al nodo successivo del set
+        node *prev; // puntatore al nodo precedente del set
+        std::size_t hash; // hash di value, memorizzato per evitare di ricalcolarlo
 
-        if(i >= _size)
-            throw std::out_of_range("Indice fuori dal range");
+        /** 
+            Costrutture di default
+            @post next == nullptr
+            @post prev == nullptr
+        */
+        node() : next(nullptr), prev(nullptr), hash(0){}
 
-        node *curr = _head;
-        unsigned int index = 0;
+        /** 
+            Costruttore secondario, costruisce il valore sul posto
+            inoltrando gli argomenti al costruttore di T
+            @param h hash del valore
+            @param args argomenti per il costruttore di T
 
-        while(curr != nullptr){
-            if(index == i)
-                return curr->value;
-            
-                curr = curr->next;
-                ++index;
-        }
+            @post next == nullptr
+            @post prev == nullptr
+        */
+        template<typename... Args>
+        node(std::true_type, std::size_t h, Args&&... args)
+            : value(std::forward<Args>(args)...), next(nullptr), prev(nullptr), hash(h){}
 
-        throw std::out_of_range("Indice fuori dal range");
-    }
+        /** 
+            Costruttore secondario per gli aggregati (ad esempio Attivita),
+            che non hanno un costruttore con gli argomenti passati:
+            il valore viene inizializzato con le graffe
+            @param h hash del valore
+            @param args valori dei campi di T
+
+            @post next == nullptr
+            @post prev == nullptr
+        */
+        template<typename... Args>
+        node(std::false_type, std::size_t h, Args&&... args)
+            : value{std::forward<Args>(args)...}, next(nullptr), prev(nullptr), hash(h){}
+    }; // fine struct node
+
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<node> node_allocator;
+    typedef std::allocator_traits<node_allocator> node_traits;
+
+    // Valori iniziali del set vuoto, usati da ogni costruttore
+    // che non li inizializza esplicitamente
+    node *_head = nullptr; // puntatore all'inizio del set
+    node *_tail = nullptr; // puntatore all'ultimo elemento del set
+    unsigned int _size = 0; // dimensione del set
+    node **_buckets = nullptr; // tabella hash dei nodi (nullptr = slot libero)
+    std::size_t _capacity = 0; // numero di slot della tabella, 0 o potenza di 2
+    Hash _hasher; // funtore di hashing
+    node_allocator _alloc; // allocatore dei nodi
+    node *_cursor = nullptr; // ultimo nodo visitato da operator[] non const (nullptr = non valido)
+    unsigned int _cursor_index = 0; // indice di _cursor
+    mutable std::atomic<node**> _index{nullptr}; // nodi in ordine per operator[] const (nullptr = da costruire)
 
     /** 
-        @brief Operatore di intersezione tra due set
+        @brief Crea un nuovo nodo con l'allocatore del set
 
-        Restituisce un nuovo set contenente gli elementi
-        presenti sia nel set corrente sia nel set passato
-        come parametro. 
-        L'operatore non modifica i set originali. 
+        Il valore viene costruito direttamente nel nodo a partire
+        dagli argomenti, senza copie intermedie.
 
-        @param other set con cui calcolare l'intersezione
-        @return nuovo set risultato dell'intersezione.
+        @param h hash del valore
+        @param args argomenti per la costruzione del valore
+        @return puntatore al nuovo nodo
+        @throw std::bad_alloc possibile eccezione di allocazione
+        @throw qualunque eccezione sollevata dal costruttore di T
     */
-    set operator-(const set &other) const{
+    template<typename... Args>
+    node* create_node(std::size_t h, Args&&... args){
+        node *n = node_traits::allocate(_alloc, 1);
 
-        set risultato;
+        try{
+            typename std::is_constructible<T, Args&&...>::type con_costruttore;
+            node_traits::construct(_alloc, n, con_costruttore, h, std::forward<Args>(args)...);
+        }catch(...){
+            node_traits::deallocate(_alloc, n, 1);
+            throw;
+        }
 
-        const_iterator it = begin();
-        const_iterator it_end = end();
+        return n;
+    }
 
-        while(it != it_end){
-            if(other.contains(*it)){
-                risultato.add(*it);
-            }
-            
-            ++it;
-        }
+    /** 
+        @brief Distrugge un nodo e ne restituisce la memoria all'allocatore
 
-        return risultato;
+        @param n nodo da distruggere
+    */
+    void destroy_node(node *n){
+        node_traits::destroy(_alloc, n);
+        node_traits::deallocate(_alloc, n, 1);
     }
 
     /** 
-        @brief Costruttore da intervallo di iteratori
+        @brief Calcola l'hash di un valore
+
+        L'hash prodotto dal funtore viene rimescolato (finalizzatore di MurmurHash3)
+        in modo che anche hash poco distribuiti, come l'identità usata
+        per gli interi, si distribuiscano bene su una tabella con capacità
+        potenza di 2.
+
+        @param value valore di cui calcolare l'hash
+        @return hash rimescolato
+    */
+    std::size_t hash_of(const T &value) const{
+        unsigned long long h = static_cast<unsigned long long>(_hasher(value));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return static_cast<std::size_t>(h);
+    }
+
+    /** 
+        @brief Cerca lo slot della tabella relativo a un valore
+
+        Scorre la tabella a partire dalla posizione indicata dall'hash
+        fino a trovare il nodo che contiene il valore o uno slot libero.
+
+        @param value valore da cercare
+        @param h hash del valore
+        @return indice dello slot che contiene il valore o del primo slot libero
+        @pre _capacity > 0
+    */
+    std::size_t find_slot(const T &value, std::size_t h) const{
+        std::size_t mask = _capacity - 1;
+        std::size_t i = h & mask;
+
+        while(_buckets[i] != nullptr){
+            if(_buckets[i]->hash == h && _buckets[i]->value == value)
+                return i;
+            i = (i + 1) & mask;
+        }
+
+        return i;
+    }
+
+    /** 
+        @brief Ridimensiona la tabella hash
+
+        Alloca una nuova tabella della capacità richiesta e vi reinserisce
+        tutti i nodi usando l'hash memorizzato. In caso di eccezione
+        durante l'allocazione il set rimane invariato.
+
+        @param capacity nuova capacità, potenza di 2 maggiore di _size
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void rehash(std::size_t capacity){
+        node **buckets = new node*[capacity]();
+        std::size_t mask = capacity - 1;
+
+        for(node *curr = _head; curr != nullptr; curr = curr->next){
+            std::size_t i = curr->hash & mask;
+            while(buckets[i] != nullptr)
+                i = (i + 1) & mask;
+            buckets[i] = curr;
+        }
+
+        delete[] _buckets;
+        _buckets = buckets;
+        _capacity = capacity;
+    }
+
+    /** 
+        @brief Garantisce spazio nella tabella per n elementi
+
+        La tabella viene mantenuta con un fattore di carico al massimo 1/2,
+        così le sequenze di probing restano corte.
+
+        @param n numero di elementi da poter contenere
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void grow_for(std::size_t n){
+        if(n * 2 <= _capacity)
+            return;
+
+        std::size_t capacity = _capacity == 0 ? 8 : _capacity;
+        while(capacity < n * 2)
+            capacity *= 2;
+
+        rehash(capacity);
+    }
+
+    /** 
+        @brief Libera uno slot della tabella
+
+        Usa la cancellazione con spostamento all'indietro: gli elementi
+        successivi della stessa sequenza di probing vengono spostati per
+        riempire il buco, così non servono marcatori di cancellazione.
+
+        @param i indice dello slot da liberare
+    */
+    void erase_slot(std::size_t i){
+        std::size_t mask = _capacity - 1;
+        std::size_t j = i;
+
+        _buckets[i] = nullptr;
+
+        while(true){
+            j = (j + 1) & mask;
+            if(_buckets[j] == nullptr)
+                return;
+
+            std::size_t k = _buckets[j]->hash & mask; // slot ideale
+
+            // se k non sta ciclicamente in (i, j] l'elemento può essere spostato in i
+            bool da_spostare = (i <= j) ? (k <= i || k > j) : (k <= i && k > j);
+            if(da_spostare){
+                _buckets[i] = _buckets[j];
+                _buckets[j] = nullptr;
+                i = j;
+            }
+        }
+    }
+
+    /** 
+        @brief Verifica la presenza di un valore di cui è già noto l'hash
+
+        Usata con l'hash memorizzato nei nodi di un altro set dello stesso
+        tipo, per non ricalcolarlo (i due funtori di hashing devono
+        comportarsi allo stesso modo).
+
+        @param value valore da cercare
+        @param h hash rimescolato del valore
+        @return true se il valore è presente, false altrimenti
+    */
+    bool contains_hashed(const T &value, std::size_t h) const{
+        if(_size == 0)
+            return false;
+
+        return _buckets[find_slot(value, h)] != nullptr;
+    }
+
+    /** 
+        @brief Collega un nuovo nodo in testa alla lista e nella tabella
+
+        @param n nodo da collegare, il cui valore non è presente nel set
+        @pre la tabella ha spazio per un elemento in più
+    */
+    void link_node(node *n){
+
+        // inserimento in testa
+        n->next = _head;
+        if(_head != nullptr)
+            _head->prev = n;
+        else
+            _tail = n;
+        _head = n;
+
+        _buckets[find_slot(n->value, n->hash)] = n;
+
+        ++_size;
+
+        // gli elementi esistenti slittano in avanti di una posizione
+        ++_cursor_index;
+        invalidate_index();
+    }
+
+    /** 
+        @brief Inserisce un valore di cui è già noto l'hash
+
+        Inserisce il valore solo se non è già presente. Il valore viene
+        copiato o spostato nel nodo a seconda di come è passato.
+
+        @tparam V tipo del valore (T, T& o const T&)
+        @param value valore da inserire
+        @param h hash rimescolato del valore
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    template<typename V>
+    void add_hashed(V &&value, std::size_t h){
+
+        // se già presente, non fare nulla
+        if(contains_hashed(value, h))
+            return;
+
+        grow_for(_size + 1);
+
+        link_node(create_node(h, std::forward<V>(value)));
+    }
+
+    static const std::size_t max_reserve_range = 1 << 16; // elementi riservati al massimo da reserve_range
+
+    /** 
+        @brief Dimensiona la tabella per un intervallo di iteratori forward
+
+        Il numero di elementi dell'intervallo viene calcolato senza consumare
+        l'intervallo, ma conta anche i duplicati: la tabella viene quindi
+        dimensionata per al più max_reserve_range elementi in più, così un
+        intervallo lungo con pochi valori distinti non lascia una tabella
+        enorme. Oltre quel limite la tabella cresce durante gli inserimenti.
+    */
+    template<typename Iterator>
+    void reserve_range(Iterator first, Iterator last, std::forward_iterator_tag){
+        std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+        grow_for(_size + (n < max_reserve_range ? n : max_reserve_range));
+    }
+
+    /** 
+        @brief Versione per iteratori di input: l'intervallo può essere
+        letto una sola volta, quindi la tabella cresce durante gli inserimenti
+    */
+    template<typename Iterator>
+    void reserve_range(Iterator, Iterator, std::input_iterator_tag){}
+
+    /** 
+        @brief Inserisce un elemento di insert_bulk che è già di tipo T
+
+        L'hash viene calcolato sull'elemento stesso e il valore viene
+        copiato (o spostato, se l'iteratore restituisce T&&) nel nodo
+        solo se non è già presente.
+    */
+    template<typename V>
+    void add_from_range(V &&value, std::true_type){
+        std::size_t h = hash_of(value);
+        add_hashed(std::forward<V>(value), h);
+    }
+
+    /** 
+        @brief Inserisce un elemento di insert_bulk di un tipo diverso da T
+
+        Serve un T per calcolarne l'hash: viene costruito una volta
+        e spostato nel nodo se il valore non è già presente.
+    */
+    template<typename V>
+    void add_from_range(V &&value, std::false_type){
+        add(static_cast<T>(std::forward<V>(value)));
+    }
+
+    /** 
+        @brief Scarta l'indice posizionale usato da operator[] const
+
+        Chiamata da ogni operazione che cambia la lista. Come queste,
+        non può essere eseguita in concorrenza con letture dello stesso set.
+    */
+    void invalidate_index(){
+        if(_index.load(std::memory_order_relaxed) != nullptr)
+            delete[] _index.exchange(nullptr, std::memory_order_relaxed);
+    }
+
+    /** 
+        @brief Restituisce l'indice posizionale, costruendolo se manca
+
+        Più thread che leggono lo stesso set possono costruirlo insieme:
+        solo il primo lo pubblica con compare_exchange, gli altri
+        scartano la propria copia e usano quella pubblicata.
+
+        @return array di _size puntatori ai nodi, nell'ordine della lista
+        @throw std::bad_alloc possibile eccezione di allocazione
+        @pre _size > 0
+    */
+    node** positional_index() const{
+        node **indice = _index.load(std::memory_order_acquire);
+        if(indice != nullptr)
+            return indice;
+
+        node **nuovo = new node*[_size];
+        unsigned int k = 0;
+        for(node *curr = _head; curr != nullptr; curr = curr->next)
+            nuovo[k++] = curr;
+
+        if(_index.compare_exchange_strong(indice, nuovo, std::memory_order_acq_rel, std::memory_order_acquire))
+            return nuovo;
+
+        delete[] nuovo;
+        return indice;
+    }
+
+    /** 
+        @brief Restituisce il nodo in posizione i
+
+        Parte dal punto più vicino tra testa, coda e cursore e scorre
+        la lista in avanti o all'indietro. Il cursore viene solo letto.
+
+        @param i indice del nodo
+        @return puntatore al nodo in posizione i
+        @pre i < _size
+    */
+    node* node_at(unsigned int i) const{
+        node *curr = _head;
+        unsigned int index = 0;
+        unsigned int distanza = i;
+
+        if(_size - 1 - i < distanza){
+            curr = _tail;
+            index = _size - 1;
+            distanza = _size - 1 - i;
+        }
+
+        if(_cursor != nullptr){
+            unsigned int dal_cursore = (i > _cursor_index) ? i - _cursor_index : _cursor_index - i;
+            if(dal_cursore < distanza){
+                curr = _cursor;
+                index = _cursor_index;
+            }
+        }
+
+        while(index < i){
+            curr = curr->next;
+            ++index;
+        }
+
+        while(index > i){
+            curr = curr->prev;
+            --index;
+        }
+
+        return curr;
+    }
+
+    public:
+
+    /** 
+        Costruttore di default
+
+        @post _head == nullptr
+        @post _size == 0
+    */
+    set() : _head(nullptr), _tail(nullptr), _size(0), _buckets(nullptr), _capacity(0),
+            _cursor(nullptr), _cursor_index(0) {}
+
+    /** 
+        Copy constructor
+        
+        @param other set da copiare
+
+        @throw std::bad_alloc possibie eccezione di allocazione
+    */
+    set(const set &other) : _head(nullptr), _tail(nullptr), _size(0), _buckets(nullptr), _capacity(0),
+                            _hasher(other._hasher),
+                            _alloc(node_traits::select_on_container_copy_construction(other._alloc)),
+                            _cursor(nullptr), _cursor_index(0){
+        node *curr = other._head;
+
+        try
+        {
+           grow_for(other._size);
+           while(curr != nullptr){
+                add_hashed(curr->value, curr->hash);
+                curr = curr->next;
+           }
+        }
+        catch(...)
+        {
+            clear();
+            throw;
+        }
+    }
+
+    /** 
+        Operatore di assegnamento
+
+        @param other set da copiare
+        @return reference al set this
+        @throw std::bad_alloc possibile eccezione di allocazione
+     
+    */
+    set& operator=(const set &other){
+        if(this != &other){
+            set temp(other);
+            this->swap(temp);
+        }
+        return *this;
+    }
+
+    /** 
+        Move constructor, prende gli elementi di other senza copiarli
+
+        @param other set da spostare
+
+        @post other.size() == 0
+    */
+    set(set &&other) noexcept : _head(other._head), _tail(other._tail), _size(other._size),
+                                _buckets(other._buckets), _capacity(other._capacity),
+                                _hasher(other._hasher), _alloc(std::move(other._alloc)),
+                                _cursor(other._cursor), _cursor_index(other._cursor_index),
+                                _index(other._index.exchange(nullptr, std::memory_order_relaxed)){
+        other._head = nullptr;
+        other._tail = nullptr;
+        other._size = 0;
+        other._buckets = nullptr;
+        other._capacity = 0;
+        other._cursor = nullptr;
+        other.invalidate_index();
+    }
+
+    /** 
+        Operatore di assegnamento per spostamento
+
+        Libera gli elementi correnti e prende quelli di other senza copiarli.
+
+        @param other set da spostare
+        @return reference al set this
+
+        @post other.size() == 0
+    */
+    set& operator=(set &&other) noexcept{
+        if(this != &other){
+            clear();
+            this->swap(other);
+        }
+        return *this;
+    }
+
+    /** 
+        Distruttore, svuota il set
+
+        @post _head == nullptr
+        @post _size == 0;
+    */
+    ~set(){
+       clear();
+    }
+
+    /** 
+        Svuota il set
+
+        Con pool_allocator i nodi non vengono restituiti uno alla volta:
+        dopo averli distrutti (se T ha un distruttore non banale)
+        i blocchi del pool vengono liberati tutti insieme.
+
+        @post _head == nullptr
+        @post _size == 0;
+    */
+    void clear(){
+       const bool a_blocchi = pool_traits<node_allocator>::releases_blocks;
+
+       if(!a_blocchi || !std::is_trivially_destructible<T>::value){
+           node *curr = _head;
+           while(curr != nullptr){
+            node *tmp = curr->next;
+            if(a_blocchi)
+                node_traits::destroy(_alloc, curr);
+            else
+                destroy_node(curr);
+            curr = tmp;
+           }
+       }
+
+       pool_traits<node_allocator>::release(_alloc);
+
+       delete[] _buckets;
+
+       _size = 0;
+       _head = nullptr;
+       _tail = nullptr;
+       _buckets = nullptr;
+       _capacity = 0;
+       _cursor = nullptr;
+       invalidate_index();
+    }
+
+    /** 
+        Funzione di swap che scambia il set corrente con quello passato come parametro
+
+        @param other set da scambiare
+    */
+    void swap(set &other){
+        std::swap(_head, other._head);
+        std::swap(_tail, other._tail);
+        std::swap(_size, other._size);
+        std::swap(_buckets, other._buckets);
+        std::swap(_capacity, other._capacity);
+        std::swap(_hasher, other._hasher);
+        std::swap(_cursor, other._cursor);
+        std::swap(_cursor_index, other._cursor_index);
+
+        node **indice = _index.load(std::memory_order_relaxed);
+        _index.store(other._index.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other._index.store(indice, std::memory_order_relaxed);
+
+        using std::swap;
+        swap(_alloc, other._alloc);
+   }
+
+    /** 
+        @brief Verifica se un valore è presente nel set
+
+        @param p valore da cercare
+        @return treu se il valore è presente, false altrimenti
+    */
+    bool contains(const T &p) const{
+        return contains_hashed(p, hash_of(p));
+    }
+    /** 
+        @brief Ritorna la dimensione del set
+
+        @return _size
+    */
+    unsigned int size() const{
+        return _size;
+    }
+
+    /** 
+        @brief Inserisce un valore nel set
+
+        Inserisce il valore solo se non è già presente.
+
+        @param value valore da inserire
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void add(const T &value){
+        add_hashed(value, hash_of(value));
+    }
+
+    /** 
+        @brief Inserisce un valore nel set spostandolo
+
+        Inserisce il valore solo se non è già presente; in tal caso
+        il valore viene spostato nel nodo senza essere copiato.
+
+        @param value valore da inserire
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void add(T &&value){
+        add_hashed(std::move(value), hash_of(value));
+    }
+
+    /** 
+        @brief Costruisce un valore direttamente nel set
+
+        Il valore viene costruito nel nodo a partire dagli argomenti
+        (con le graffe se T è un aggregato, come Attivita) e inserito solo
+        se non è già presente, altrimenti viene distrutto.
+
+        @param args argomenti per la costruzione del valore
+        @throw std::bad_alloc possibile eccezione di allocazione
+        @throw qualunque eccezione sollevata dal costruttore di T
+    */
+    template<typename... Args>
+    void emplace(Args&&... args){
+
+        node *n = create_node(0, std::forward<Args>(args)...);
+
+        try{
+            n->hash = hash_of(n->value);
+
+            // se già presente, il nodo viene scartato
+            if(contains_hashed(n->value, n->hash)){
+                destroy_node(n);
+                return;
+            }
+
+            grow_for(_size + 1);
+        }catch(...){
+            destroy_node(n);
+            throw;
+        }
+
+        link_node(n);
+    }
+
+    /** 
+        @brief Rimuove un valore dal set
+
+        Se il valore non è presente, il set rimane invariato
+
+        @param value valore da rimuovere
+    */
+    void remove(const T &value){
+
+        // caso set vuoto
+        if(_size == 0)
+            return;
+
+        std::size_t i = find_slot(value, hash_of(value));
+        node *tmp = _buckets[i];
+
+        // valore non presente
+        if(tmp == nullptr)
+            return;
+
+        erase_slot(i);
+
+        if(tmp->prev != nullptr)
+            tmp->prev->next = tmp->next;
+        else
+            _head = tmp->next;
+
+        if(tmp->next != nullptr)
+            tmp->next->prev = tmp->prev;
+        else
+            _tail = tmp->prev;
+
+        // la posizione del nodo rimosso non è nota: il cursore viene invalidato
+        _cursor = nullptr;
+        invalidate_index();
+
+        destroy_node(tmp);
+        --_size;
+    }
+
+    /** 
+        @brief Operatore di uguaglianza tra due set
+
+        Due set sono considerati uguali se contengono
+        gli stessi elementi indipendentemente dall'ordine. 
+        Il confronto è lineare: ogni elemento viene cercato nella
+        tabella hash dell'altro set riusando l'hash memorizzato nel nodo.
+
+        @param other set da confrontare con l'oggetto corrente
+        @return true se i due set contengono gli stessi elementi, false altrimenti
+    */
+    bool operator==(const set &other) const{
+
+        if(this->_size != other._size)
+            return false;
+
+        node *curr = _head;
+        while(curr != nullptr){
+            if(!other.contains_hashed(curr->value, curr->hash))
+                return false;
+            curr = curr->next;
+        }
+
+        return true;
+    }
+
+    /** 
+        @brief Operatore di accesso in lettura
+
+        Il primo accesso costruisce in O(n) un array con i nodi in ordine,
+        i successivi costano O(1) finché il set non viene modificato
+        (add, emplace, remove, clear, merge scartano l'array).
+        L'array occupa un puntatore per elemento.
+        Letture concorrenti dello stesso set sono sicure: l'array viene
+        pubblicato in modo atomico e non viene mai modificato.
+
+        @param i indice dell'elemento
+        @return riferimento costante all'elemento
+        @throw std::out_of_range se l'indice non è valido
+        @throw std::bad_alloc possibile eccezione di allocazione al primo accesso
+    */
+    const T& operator[](unsigned int i) const{
+
+        if(i >= _size)
+            throw std::out_of_range("Indice fuori dal range");
+
+        return positional_index()[i]->value;
+    }
+
+    /** 
+        @brief Operatore di accesso in lettura e scrittura 
+
+        Il set ricorda l'ultimo nodo visitato e il suo indice, così gli
+        accessi sequenziali (s[0], s[1], ...) costano O(1) ammortizzato.
+
+        @note aggiorna il cursore: come ogni operazione non const
+        richiede una sincronizzazione esterna tra thread.
+
+        @param i indice dell'elemento
+        @return riferimento costante all'elemento
+        @throw std::out_of_range se l'indice non è valido
+    */
+    T& operator[](unsigned int i){
+
+        if(i >= _size)
+            throw std::out_of_range("Indice fuori dal range");
+
+        _cursor = node_at(i);
+        _cursor_index = i;
+
+        return _cursor->value;
+    }
+
+    /** 
+        @brief Operatore di intersezione tra due set
+
+        Restituisce un nuovo set contenente gli elementi
+        presenti sia nel set corrente sia nel set passato
+        come parametro. 
+        L'operatore non modifica i set originali. 
+
+        Si scorre il set più piccolo cercando ogni elemento nella tabella
+        hash del più grande, quindi il costo è O(min(n, m)).
+
+        @param other set con cui calcolare l'intersezione
+        @return nuovo set risultato dell'intersezione.
+    */
+    set operator-(const set &other) const{
+
+        const set &piccolo = (_size <= other._size) ? *this : other;
+        const set &grande = (_size <= other._size) ? other : *this;
+
+        set risultato;
+
+        node *curr = piccolo._head;
+        while(curr != nullptr){
+            if(grande.contains_hashed(curr->value, curr->hash)){
+                risultato.add_hashed(curr->value, curr->hash);
+            }
+
+            curr = curr->next;
+        }
+
+        return risultato;
+    }
+
+    /** 
+        @brief Differenza tra due set
+
+        Restituisce un nuovo set contenente gli elementi del set corrente
+        che non sono presenti nel set passato come parametro, in O(n).
+        La funzione non modifica i set originali.
+
+        @param other set da sottrarre
+        @return nuovo set risultato della differenza
+    */
+    set difference(const set &other) const{
+
+        set risultato;
+
+        node *curr = _head;
+        while(curr != nullptr){
+            if(!other.contains_hashed(curr->value, curr->hash)){
+                risultato.add_hashed(curr->value, curr->hash);
+            }
+
+            curr = curr->next;
+        }
+
+        return risultato;
+    }
+
+    /** 
+        @brief Differenza simmetrica tra due set
+
+        Restituisce un nuovo set contenente gli elementi presenti
+        in uno solo dei due set, in O(n + m).
+        La funzione non modifica i set originali.
+
+        @param other set con cui calcolare la differenza simmetrica
+        @return nuovo set risultato della differenza simmetrica
+    */
+    set symmetric_difference(const set &other) const{
+
+        set risultato(difference(other));
+
+        node *curr = other._head;
+        while(curr != nullptr){
+            if(!contains_hashed(curr->value, curr->hash)){
+                risultato.add_hashed(curr->value, curr->hash);
+            }
+
+            curr = curr->next;
+        }
+
+        return risultato;
+    }
+
+    /** 
+        @brief Costruttore da intervallo di iteratori
 
         Crea un set a partire da una coppia generica di iteratori. Gli elementi
-        compresi nell'intervallo [first, last) vengono inseriti nel set con la funzione add()
+        compresi nell'intervallo [first, last) vengono inseriti nel set con insert_bulk()
         che garantisce l'assenza di duplicati. In caso si eccezioni durante l'inserimento
         o l'allocazione dinamica della memoria, il set viene svuotato per evitare memory leak
         e l'eccezione viene rilanciata. 
@@ -405,22 +1334,122 @@ class set{
         @throw qualunque eccezione sollevata durante l'inseriemento
     */
     template<typename Iterator>
-    set(Iterator first, Iterator last) : _head(nullptr), _size(0){
+    set(Iterator first, Iterator last) : _head(nullptr), _tail(nullptr), _size(0), _buckets(nullptr),
+                                         _capacity(0), _cursor(nullptr), _cursor_index(0){
 
         try{
-            while(first != last){
-                add(static_cast<T>(*first));
-                ++first;
-            }
+            insert_bulk(first, last);
         }catch (...){
             clear();
             throw;
         }
     }
 
+    /** 
+        @brief Riserva spazio nella tabella hash per n elementi
+
+        Dopo la chiamata, inserire fino a n elementi in totale
+        non provoca ridimensionamenti della tabella.
 
-    template<typename U>
-    friend std::ostream& operator<<(std::ostream&, const set<U>&);
+        @param n numero di elementi da poter contenere
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void reserve(unsigned int n){
+        grow_for(n);
+    }
+
+    /** 
+        @brief Inserisce nel set tutti gli elementi di un intervallo
+
+        Se l'intervallo è percorribile più volte (iteratori forward o superiori)
+        la tabella viene dimensionata una sola volta per gli elementi
+        (vedi reserve_range), poi ogni elemento viene inserito scartando
+        i duplicati con la tabella hash. Gli elementi di tipo T vengono
+        cercati così come sono e copiati solo se non sono già presenti.
+        Il costo complessivo è lineare nel numero di elementi.
+        In caso di eccezione gli elementi già inseriti restano nel set.
+
+        @tparam Iterator tipo dell'iteratore
+        @param first iteratore all'inizio dell'intervallo
+        @param last iteratore alla fine dell'intervallo
+        @throw qualunque eccezione sollevata durante l'inserimento
+    */
+    template<typename Iterator>
+    void insert_bulk(Iterator first, Iterator last){
+        typedef typename std::iterator_traits<Iterator>::iterator_category categoria;
+        typedef typename std::iterator_traits<Iterator>::reference riferimento;
+        typedef typename std::is_same<typename std::decay<riferimento>::type, T>::type di_tipo_T;
+        reserve_range(first, last, categoria());
+
+        while(first != last){
+            add_from_range(*first, di_tipo_T());
+            ++first;
+        }
+    }
+
+    /** 
+        @brief Sposta nel set tutti gli elementi di other
+
+        A differenza di std::unordered_set::merge other viene sempre svuotato:
+        i nodi con valori non presenti vengono ricollegati in questo set senza
+        copiare né riallocare i valori, gli altri vengono distrutti.
+        Con pool_allocator il set prende possesso dei blocchi di other;
+        con allocatori diversi tra loro i valori vengono invece spostati
+        in nodi nuovi.
+        Gli elementi di other compaiono in testa, nello stesso ordine che
+        avrebbero se fossero stati aggiunti uno alla volta con add,
+        a partire dal primo inserito in other.
+
+        @param other set da svuotare
+        @throw std::bad_alloc possibile eccezione di allocazione; con pool_allocator
+        o allocatori uguali i due set rimangono invariati
+
+        @post other.size() == 0
+    */
+    void merge(set &other){
+        if(this == &other)
+            return;
+
+        grow_for(_size + other._size);
+
+        if(!pool_traits<node_allocator>::adopt(_alloc, other._alloc)){
+            for(node *curr = other._tail; curr != nullptr; curr = curr->prev)
+                add_hashed(std::move(curr->value), curr->hash);
+            other.clear();
+            return;
+        }
+
+        node *curr = other._tail;
+        while(curr != nullptr){
+            node *tmp = curr->prev;
+
+            if(contains_hashed(curr->value, curr->hash))
+                destroy_node(curr);
+            else{
+                curr->prev = nullptr;
+                link_node(curr);
+            }
+
+            curr = tmp;
+        }
+
+        delete[] other._buckets;
+
+        other._head = nullptr;
+        other._tail = nullptr;
+        other._size = 0;
+        other._buckets = nullptr;
+        other._capacity = 0;
+        other._cursor = nullptr;
+        other.invalidate_index();
+    }
+
+
+    template<typename U, typename H, typename A>
+    friend std::ostream& operator<<(std::ostream&, const set<U, H, A>&);
+
+    template<typename U, typename H, typename A>
+    friend set<U, H, A> operator+(const set<U, H, A>&, const set<U, H, A>&);
 
 
 
@@ -431,31 +1460,160 @@ class set{
         @brief Iteratore forward per la classe set
 
         Permette di scorrere gli elementi del set e di accedere in lettura
-        e scrittura ai valori contenuti. Implementa un iteratore di tipo forward. 
+        e scrittura ai valori contenuti. Implementa un iteratore di tipo bidirezionale:
+        decrementando end() si ottiene l'ultimo elemento. 
+    */
+	class iterator {
+		//	
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef T                         value_type;
+		typedef ptrdiff_t                 difference_type;
+		typedef T*                        pointer;
+		typedef T&                        reference;
+
+	
+		iterator() : current(nullptr), owner(nullptr){}
+		
+		iterator(const iterator &other) : current(other.current), owner(other.owner){}
+
+		iterator& operator=(const iterator &other) {
+			if (this != &other){
+                current = other.current;
+                owner = other.owner;
+            }
+
+            return *this;
+		}
+
+		~iterator() {}
+
+		// Ritorna il dato riferito dall'iteratore (dereferenziamento)
+		reference operator*() const {
+			return current->value;
+		}
+
+		// Ritorna il puntatore al dato riferito dall'iteratore
+		pointer operator->() const {
+			return &(current->value);
+		}
+
+		// Operatore di iterazione post-incremento
+		iterator operator++(int) {
+			iterator tmp(*this);
+            current = current->next;
+            return tmp;
+		}
+
+		// Operatore di iterazione pre-incremento
+		iterator& operator++() {
+			current = current->next;
+            return *this;
+		}
+
+		// Operatore di iterazione post-decremento
+		iterator operator--(int) {
+			iterator tmp(*this);
+            --(*this);
+            return tmp;
+		}
+
+		// Operatore di iterazione pre-decremento, da end() porta all'ultimo elemento
+		iterator& operator--() {
+			current = (current != nullptr) ? current->prev : owner->_tail;
+            return *this;
+		}
+
+		// Uguaglianza
+		bool operator==(const iterator &other) const {
+			return current == other.current;
+		}
+
+		// Diversita'
+		bool operator!=(const iterator &other) const {
+			return current != other.current;
+		}
+		
+		
+		friend class const_iterator;
+
+		// Uguaglianza
+		bool operator==(const const_iterator &other) const {
+			return current == other.current;
+		}
+
+		// Diversita'
+		bool operator!=(const const_iterator &other) const {
+			return current != other.current;
+		}
+
+		// Solo se serve anche const_iterator aggiungere le precedenti definizioni
+
+	private:
+		node* current;  //Dati membro
+		const set* owner; // set di appartenenza, usato per decrementare end()
+
+		friend class set; 
+
+		
+		iterator(node* n, const set* s) : current(n), owner(s) { 
+			//!!! 
+		}
+	
+		
+	}; // classe iterator
+	
+	/** 
+        @brief Restituisce un iteratore all'inizio del set
+
+        @return iteratore al primo elemento
+    */
+	iterator begin() {
+		return iterator(_head, this);
+	}
+	
+	/** 
+        @brief Restituisce un iteratore alla fine del set
+
+        L'iteratore restituito non fa riferimento ad alcun elemento
+
+        @return iteratore alla fine del set
+    */
+	iterator end() {
+		return iterator(nullptr, this);
+	}
+	
+	
+	/** 
+        @brief Iteratore costante per la classe set
+
+        Permette di scorrere gli elementi del set in sola lettura. 
+        Non consente la modifica dei vari valori a cui punta. 
+        Implementa un iteratore di tipo bidirezionale. 
     */
-	class iterator {
+	class const_iterator {
 		//	
 	public:
-		typedef std::forward_iterator_tag iterator_category;
+		typedef std::bidirectional_iterator_tag iterator_category;
 		typedef T                         value_type;
 		typedef ptrdiff_t                 difference_type;
-		typedef T*                        pointer;
-		typedef T&                        reference;
+		typedef const T*                  pointer;
+		typedef const T&                  reference;
 
 	
-		iterator() : current(nullptr){}
+		const_iterator() : current(nullptr), owner(nullptr){}
 		
-		iterator(const iterator &other) : current(other.current){}
+		const_iterator(const const_iterator &other) : current(other.current), owner(other.owner) {}
 
-		iterator& operator=(const iterator &other) {
+		const_iterator& operator=(const const_iterator &other) {
 			if (this != &other){
                 current = other.current;
+                owner = other.owner;
             }
-
             return *this;
 		}
 
-		~iterator() {}
+		~const_iterator() {}
 
 		// Ritorna il dato riferito dall'iteratore (dereferenziamento)
 		reference operator*() const {
@@ -466,340 +1624,1002 @@ class set{
 		pointer operator->() const {
 			return &(current->value);
 		}
-
+		
 		// Operatore di iterazione post-incremento
-		iterator operator++(int) {
-			iterator tmp(*this);
+		const_iterator operator++(int) {
+			const_iterator tmp(*this);
             current = current->next;
             return tmp;
 		}
 
 		// Operatore di iterazione pre-incremento
-		iterator& operator++() {
+		const_iterator& operator++() {
 			current = current->next;
             return *this;
 		}
 
+		// Operatore di iterazione post-decremento
+		const_iterator operator--(int) {
+			const_iterator tmp(*this);
+            --(*this);
+            return tmp;
+		}
+
+		// Operatore di iterazione pre-decremento, da end() porta all'ultimo elemento
+		const_iterator& operator--() {
+			current = (current != nullptr) ? current->prev : owner->_tail;
+            return *this;
+		}
+
 		// Uguaglianza
-		bool operator==(const iterator &other) const {
+		bool operator==(const const_iterator &other) const {
 			return current == other.current;
 		}
-
+		
 		// Diversita'
-		bool operator!=(const iterator &other) const {
+		bool operator!=(const const_iterator &other) const {
 			return current != other.current;
 		}
+
 		
-		
-		friend class const_iterator;
+		friend class iterator;
 
 		// Uguaglianza
-		bool operator==(const const_iterator &other) const {
+		bool operator==(const iterator &other) const {
 			return current == other.current;
 		}
 
 		// Diversita'
-		bool operator!=(const const_iterator &other) const {
+		bool operator!=(const iterator &other) const {
 			return current != other.current;
 		}
 
-		// Solo se serve anche const_iterator aggiungere le precedenti definizioni
+		// Costruttore di conversione iterator -> const_iterator
+		const_iterator(const iterator &other) : current(other.current), owner(other.owner) {}
+
+		// Assegnamento di un iterator ad un const_iterator
+		const_iterator &operator=(const iterator &other) {
+			current = other.current;
+            owner = other.owner;
+            return *this;
+		}
+
+
+	private:
+		const node* current; //Dati membro
+		const set* owner; // set di appartenenza, usato per decrementare end()
+		
+		friend class set; // !!! Da cambiare il nome!
+
+		// Costruttore privato di inizializzazione usato dalla classe container
+		// tipicamente nei metodi begin e end
+		const_iterator(const node* n, const set* s) : current(n), owner(s) {}
+		
+	}; // classe const_iterator
+	
+	/** 
+        @brief Restituisce un iteratore costante all'inzio del set
+
+        @return iteratore costante al primo elemento
+    */
+	const_iterator begin() const {
+		return const_iterator(_head, this);
+	}
+	
+	/** 
+        @brief Restituisce un iteratore costante alla fine del set
+
+        L'iteratore restituito non fa riferimento ad alcun elemento
+
+        @return iteratore costante alla fine del set.
+    */
+	const_iterator end() const {
+		return const_iterator(nullptr, this);
+	}	
+//}; // CLASSE_CONTAINER_PADRE
+};
+
+/** 
+    @brief Operatore di output per il set
+
+    @tparam T tipo degli elementi del set
+    @tparam H funtore di hashing del set
+    @tparam A allocatore del set
+    @param os flusso di output
+    @param s set da stampare
+    @return riferimento al flusso di output
+*/
+template <typename T, typename H, typename A>
+std::ostream &operator<<(std::ostream &os, const set<T, H, A> &s){
+    
+    typename set<T, H, A>::node *curr = s._head;
+
+    os << "{";
+
+    while(curr != nullptr){
+        os << curr->value;
+        if(curr->next != nullptr)
+            os << ", ";
+        curr = curr->next;
+    }
+
+    os << "}";
+    return os;
+
+}
+
+/** 
+    @brief Operatore di unione tra due set
+
+    Restituisce un nuovo set contenente tutti gli elementi presenti
+    in almeno uno dei due set passati come parametro. L'operatore non modifica i set originali.
+    Il costo è O(n + m): gli elementi di s2 vengono inseriti riusando
+    l'hash già memorizzato nei loro nodi.
+
+    @tparam T tipo degli elementi contenuti nei set
+    @tparam H funtore di hashing dei set
+    @tparam A allocatore dei set
+    @param s1 primo set
+    @param s2 secondo set
+    @return nuovo set risultato dell'unione di s1 e s2
+*/
+template<typename T, typename H, typename A>
+set<T, H, A> operator+(const set<T, H, A>& s1, const set<T, H, A>& s2){
+
+    set<T, H, A> risultato(s1); 
+
+    typename set<T, H, A>::node *curr = s2._head;
+
+    while(curr != nullptr){
+        risultato.add_hashed(curr->value, curr->hash);
+        curr = curr->next;
+    }
+
+    return risultato;
+}
+
+/** 
+    @brief Filtra gli elementi del set secondo un predicato
+
+    @tparam T tipo degli elementi
+    @tparam H funtore di hashing del set
+    @tparam A allocatore del set
+    @tparam Predicato tipo del predicato
+    @param s set di partenza
+    @param P predicato di filtraggio
+    @return nuovo set contenente gli elementi che soddisfano il predicato
+*/
+template <typename T, typename H, typename A, typename Predicato>
+set<T, H, A> filter_out(const set<T, H, A>& s, Predicato P){
+
+    set<T, H, A> risultato;
+
+    typename set<T, H, A>::const_iterator it = s.begin();
+    typename set<T, H, A>::const_iterator it_end = s.end();
+
+    while(it != it_end){
+        if(P(*it)){
+            risultato.add(*it);
+        }
+
+        ++it;
+    }
+
+    return risultato;
+}
+
+/** 
+    @brief Nome di un file temporaneo accanto a filename
+
+    Il nome è diverso per ogni chiamata, anche tra processi diversi,
+    così due salvataggi contemporanei sullo stesso file non scrivono
+    sullo stesso temporaneo: "filename.<numero>.tmp".
+
+    @param filename file che il temporaneo andrà a sostituire
+    @return nome del file temporaneo
+*/
+inline std::string nome_temporaneo(const std::string &filename){
+    static std::atomic<unsigned long long> contatore(0);
+    static const unsigned long long seme =
+        (static_cast<unsigned long long>(std::random_device()()) << 32) ^
+        static_cast<unsigned long long>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+
+    unsigned long long n = seme + 0x9e3779b97f4a7c15ULL * ++contatore;
+    return filename + "." + std::to_string(n) + ".tmp";
+}
+
+/** 
+    @brief Porta su disco il contenuto di un file già chiuso
+
+    Il file viene riaperto e sincronizzato con fsync (FlushFileBuffers
+    su Windows): fsync agisce sul file, non sul descrittore, quindi
+    scrive anche i dati lasciati nella cache dal flusso che l'ha scritto.
+
+    @param nome file da sincronizzare
+    @return true se i dati sono su disco
+*/
+inline bool sincronizza_file(const std::string &nome){
+#ifdef _WIN32
+    HANDLE h = CreateFileA(nome.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                           nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(h == INVALID_HANDLE_VALUE)
+        return false;
+
+    bool riuscita = FlushFileBuffers(h) != 0;
+    CloseHandle(h);
+    return riuscita;
+#else
+    int fd = ::open(nome.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    bool riuscita = ::fsync(fd) == 0;
+    ::close(fd);
+    return riuscita;
+#endif
+}
+
+/** 
+    @brief Porta su disco la voce di un file nella sua cartella
+
+    Dopo una rinomina su POSIX il nuovo nome è persistente solo quando
+    la cartella che lo contiene è stata sincronizzata. I file system che
+    non permettono fsync su una cartella (EINVAL) sono considerati già
+    sincronizzati. Su Windows non c'è nulla da fare: la rinomina è fatta
+    con MOVEFILE_WRITE_THROUGH.
+
+    @param nome file di cui sincronizzare la cartella
+    @return true se la cartella è su disco
+*/
+inline bool sincronizza_cartella(const std::string &nome){
+#ifdef _WIN32
+    (void)nome;
+    return true;
+#else
+    std::string::size_type barra = nome.find_last_of('/');
+    std::string cartella = barra == std::string::npos ? std::string(".") :
+                           barra == 0 ? std::string("/") : nome.substr(0, barra);
+
+    int fd = ::open(cartella.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    bool riuscita = ::fsync(fd) == 0 || errno == EINVAL;
+    ::close(fd);
+    return riuscita;
+#endif
+}
+
+/** 
+    @brief Sostituisce un file con un altro appena scritto
+
+    Il file sorgente viene prima portato su disco (vedi sincronizza_file),
+    così dopo un'interruzione la destinazione contiene o i dati vecchi
+    o quelli nuovi completi, mai un file vuoto o troncato.
+    Su POSIX std::rename sostituisce la destinazione in modo atomico e poi
+    viene sincronizzata la cartella, su Windows lo fa MoveFileEx con
+    MOVEFILE_REPLACE_EXISTING e MOVEFILE_WRITE_THROUGH.
+    Se la sostituzione non riesce nessuno dei due file viene rimosso:
+    la destinazione resta quella precedente e i dati nuovi restano
+    nel file sorgente.
+
+    @param sorgente file appena scritto e già chiuso
+    @param destinazione file da sostituire
+    @throw std::runtime_error se la sincronizzazione o la sostituzione non riescono
+*/
+inline void sostituisci_file(const std::string &sorgente, const std::string &destinazione){
+    if(!sincronizza_file(sorgente))
+        throw std::runtime_error("Errore sincronizzazione file, i dati salvati sono in " + sorgente);
+
+#ifdef _WIN32
+    bool riuscita = MoveFileExA(sorgente.c_str(), destinazione.c_str(),
+                                MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    bool riuscita = std::rename(sorgente.c_str(), destinazione.c_str()) == 0;
+#endif
+
+    if(!riuscita)
+        throw std::runtime_error("Errore rinomina file, i dati salvati sono in " + sorgente);
+
+    if(!sincronizza_cartella(destinazione))
+        throw std::runtime_error("Errore sincronizzazione della cartella di " + destinazione);
+}
+
+/** 
+    @brief Scrittore bufferizzato di righe di Attivita
+
+    Compone le righe "titolo;ora_inizio;ora_fine" in un buffer da 1 MiB
+    (i numeri con std::to_chars, senza flussi né locale) che viene scritto
+    sul file solo quando è pieno.
+
+    Se atomico è true il contenuto viene scritto in un file temporaneo
+    (vedi nome_temporaneo) che sostituisce filename solo quando chiudi()
+    termina con successo: un'interruzione durante il salvataggio lascia
+    intatto il file precedente. Se lo scrittore viene distrutto senza
+    chiudi() o la scrittura fallisce il file temporaneo viene rimosso;
+    se fallisce solo la sostituzione il temporaneo resta su disco.
+*/
+class scrittore_attivita{
+
+    std::string _filename; // file da scrivere
+    std::string _destinazione; // file effettivamente aperto (temporaneo se atomico)
+    std::ofstream _file;
+    std::vector<char> _buffer;
+    char *_p; // prima posizione libera del buffer
+    bool _atomico;
+    bool _chiuso;
+
+    static const std::size_t blocco = 1 << 20;
+    static const std::size_t max_numeri = 2 * 11 + 3; // due int, due ';' e '\n'
+
+    scrittore_attivita(const scrittore_attivita &);
+    scrittore_attivita& operator=(const scrittore_attivita &);
+
+    /** 
+        @brief Scrive sul file il contenuto del buffer
+    */
+    void svuota(){
+        _file.write(&_buffer[0], _p - &_buffer[0]);
+        _p = &_buffer[0];
+    }
+
+    public:
+
+    /** 
+        Costruttore, apre il file di output
+
+        @param filename nome del file di output
+        @param atomico true per scrivere su un file temporaneo e poi rinominarlo
+        @throw std::runtime_error se il file non può essere aperto
+    */
+    scrittore_attivita(const std::string &filename, bool atomico)
+        : _filename(filename), _destinazione(atomico ? nome_temporaneo(filename) : filename),
+          _file(_destinazione.c_str(), std::ios::out | std::ios::binary | std::ios::trunc),
+          _buffer(blocco), _p(&_buffer[0]), _atomico(atomico), _chiuso(false){
+
+        if(!_file)
+            throw std::runtime_error("Errore apertura file");
+    }
+
+    /** 
+        Distruttore, se il file non è stato chiuso il temporaneo viene rimosso
+    */
+    ~scrittore_attivita(){
+        if(!_chiuso && _atomico){
+            _file.close();
+            std::remove(_destinazione.c_str());
+        }
+    }
+
+    /** 
+        @brief Scrive una riga
+
+        @param titolo titolo dell'attività
+        @param lunghezza lunghezza del titolo
+        @param ora_inizio ora di inizio
+        @param ora_fine ora di fine
+    */
+    void scrivi(const char *titolo, std::size_t lunghezza, int ora_inizio, int ora_fine){
+        char *fine = &_buffer[0] + blocco;
+
+        if(static_cast<std::size_t>(fine - _p) < lunghezza + max_numeri){
+            svuota();
+
+            // titolo più lungo del buffer: scritto direttamente
+            if(lunghezza + max_numeri > blocco){
+                _file.write(titolo, static_cast<std::streamsize>(lunghezza));
+                lunghezza = 0;
+            }
+        }
+
+        std::memcpy(_p, titolo, lunghezza);
+        _p += lunghezza;
+
+        *_p++ = ';';
+        _p = std::to_chars(_p, fine, ora_inizio).ptr;
+        *_p++ = ';';
+        _p = std::to_chars(_p, fine, ora_fine).ptr;
+        *_p++ = '\n';
+    }
+
+    /** 
+        @brief Completa la scrittura
+
+        Scrive il buffer, chiude il file e, se atomico, porta su disco
+        il temporaneo e sostituisce con esso il file di destinazione
+        (vedi sostituisci_file).
+
+        @throw std::runtime_error se la scrittura o la rinomina non riescono
+    */
+    void chiudi(){
+        svuota();
+        _file.close();
+        _chiuso = true;
+
+        if(!_file){
+            std::remove(_destinazione.c_str());
+            throw std::runtime_error("Errore scrittura file");
+        }
+
+        if(_atomico)
+            sostituisci_file(_destinazione, _filename);
+    }
+};
+
+/** 
+    @brief Scrive su file il contenuto di un contenitore di Attivita
+
+    Scrive ogni elemento su una riga del file, 
+    utilizzando il carattere ';' come separatore tra i campi,
+    tramite scrittore_attivita.
+    È condivisa da save() per tutti i contenitori di Attivita.
+
+    @tparam Container contenitore di Attivita dotato di const_iterator
+    @param s contenitore di Attività da salvare
+    @param filename nome del file di output
+    @param atomico true per scrivere su un file temporaneo e poi rinominarlo
+    @throw std::runtime_error se il file non può essere aperto o scritto
+*/
+template<typename Container>
+void save_attivita(const Container &s, const std::string &filename, bool atomico){
+    scrittore_attivita scrittore(filename, atomico);
+
+    for(typename Container::const_iterator it = s.begin(); it != s.end(); ++it)
+        scrittore.scrivi(it->titolo.data(), it->titolo.size(), it->ora_inizio, it->ora_fine);
+
+    scrittore.chiudi();
+}
+
+/** 
+    @brief Campi di una riga del file di Attivita
+
+    Il titolo non viene copiato: punta direttamente nel buffer di lettura
+    ed è valido solo finché il buffer non viene riutilizzato.
+*/
+struct riga_attivita{
+    const char *titolo; // inizio del titolo nel buffer
+    std::size_t lunghezza; // lunghezza del titolo
+    int ora_inizio;
+    int ora_fine;
+};
+
+/** 
+    @brief Converte un campo numerico senza usare i flussi
+
+    Ignora gli spazi iniziali e finali e usa std::from_chars,
+    che non dipende dal locale e non alloca memoria.
+
+    @param p inizio del campo
+    @param fine fine del campo
+    @param valore valore letto
+    @return true se il campo contiene esattamente un intero, false altrimenti
+*/
+inline bool parse_intero(const char *p, const char *fine, int &valore){
+    while(p != fine && *p == ' ')
+        ++p;
+    while(fine != p && *(fine - 1) == ' ')
+        --fine;
+
+    if(p == fine)
+        return false;
+
+    std::from_chars_result r = std::from_chars(p, fine, valore);
+    return r.ec == std::errc() && r.ptr == fine;
+}
+
+/** 
+    @brief Analizza una riga nel formato "titolo;ora_inizio;ora_fine"
+
+    I separatori vengono cercati con memchr. Un eventuale '\r' finale
+    (file scritti su Windows) viene ignorato.
+
+    @param p inizio della riga
+    @param fine fine della riga, escluso il '\n'
+    @param r campi letti
+    @return true se la riga è ben formata, false altrimenti
+*/
+inline bool parse_riga_attivita(const char *p, const char *fine, riga_attivita &r){
+    if(fine != p && *(fine - 1) == '\r')
+        --fine;
+
+    const char *sep1 = static_cast<const char*>(std::memchr(p, ';', fine - p));
+    if(sep1 == nullptr)
+        return false;
+
+    const char *sep2 = static_cast<const char*>(std::memchr(sep1 + 1, ';', fine - (sep1 + 1)));
+    if(sep2 == nullptr)
+        return false;
+
+    r.titolo = p;
+    r.lunghezza = static_cast<std::size_t>(sep1 - p);
+
+    return parse_intero(sep1 + 1, sep2, r.ora_inizio) &&
+           parse_intero(sep2 + 1, fine, r.ora_fine);
+}
+
+/** 
+    @brief Costruisce il messaggio di errore per una riga malformata
 
-	private:
-		node* current;  //Dati membro
+    @param filename nome del file
+    @param riga numero della riga (a partire da 1)
+    @return messaggio di errore
+*/
+inline std::string errore_riga(const std::string &filename, unsigned long riga){
+    return "Riga " + std::to_string(riga) + " malformata nel file " + filename;
+}
 
-		friend class set; 
+/** 
+    @brief Lettore a flusso di un file di Attivita
+
+    Legge il file in blocchi da 1 MiB in modalità binaria (nessuna conversione
+    dipendente dal locale) e restituisce una riga alla volta, analizzandola
+    direttamente nel buffer. Le righe a cavallo di due blocchi vengono spostate
+    all'inizio del buffer prima di leggere il blocco successivo, quindi la
+    memoria usata non dipende dalla dimensione del file.
+    Le righe vuote vengono ignorate.
+
+    Le righe possono essere lette con prossima() oppure con l'iteratore di input
+    restituito da begin(), che produce Attivita già costruite.
+    Il lettore può anche analizzare un intervallo di memoria già letto,
+    come i blocchi usati da load_parallel().
+*/
+class lettore_attivita{
 
-		
-		iterator(node* n) : current(n) { 
-			//!!! 
-		}
-	
-		
-	}; // classe iterator
-	
-	/** 
-        @brief Restituisce un iteratore all'inizio del set
+    std::ifstream _file;
+    std::string _filename; // usato nei messaggi di errore
+    std::vector<char> _buffer;
+    const char *_dati; // inizio dei dati: _buffer o l'intervallo di memoria
+    std::size_t _pos; // primo byte non ancora analizzato
+    std::size_t _pieni; // byte validi all'inizio del buffer
+    bool _ultimo; // true se il buffer contiene la fine del file
+    unsigned long _riga; // numero dell'ultima riga letta
 
-        @return iteratore al primo elemento
+    static const std::size_t BLOCCO = 1 << 20;
+
+    /**
+        @brief Sposta la riga incompleta all'inizio del buffer e legge il blocco successivo
     */
-	iterator begin() {
-		return iterator(_head);
-	}
-	
-	/** 
-        @brief Restituisce un iteratore alla fine del set
+    void riempi(){
+        _pieni -= _pos;
+        std::memmove(&_buffer[0], &_buffer[0] + _pos, _pieni);
+        _pos = 0;
+
+        if(_buffer.size() - _pieni < BLOCCO / 2){
+            _buffer.resize(_buffer.size() * 2); // riga più lunga del buffer
+            _dati = _buffer.data();
+        }
 
-        L'iteratore restituito non fa riferimento ad alcun elemento
+        _file.read(&_buffer[0] + _pieni, static_cast<std::streamsize>(_buffer.size() - _pieni));
+        std::size_t letti = static_cast<std::size_t>(_file.gcount());
+        _ultimo = (letti == 0) || !_file;
+        _pieni += letti;
+    }
 
-        @return iteratore alla fine del set
-    */
-	iterator end() {
-		return iterator(nullptr);
-	}
-	
-	
-	/** 
-        @brief Iteratore costante per la classe set
+    public:
 
-        Permette di scorrere gli elementi del set in sola lettura. 
-        Non consente la modifica dei vari valori a cui punta. 
-        Implmenta un iteratore di tipo forword. 
+    /**
+        @brief Iteratore di input sulle Attivita del file
+
+        Ogni incremento legge la riga successiva nella stessa Attivita,
+        così il titolo riusa la memoria già allocata. Come per
+        std::istream_iterator il file può essere percorso una sola volta.
     */
-	class const_iterator {
-		//	
-	public:
-		typedef std::forward_iterator_tag iterator_category;
-		typedef T                         value_type;
-		typedef ptrdiff_t                 difference_type;
-		typedef const T*                  pointer;
-		typedef const T&                  reference;
+    class iterator{
 
-	
-		const_iterator() : current(nullptr){}
-		
-		const_iterator(const const_iterator &other) : current(other.current) {}
+        lettore_attivita *_lettore; // nullptr per l'iteratore di fine
+        Attivita _corrente;
 
-		const_iterator& operator=(const const_iterator &other) {
-			if (this != &other){
-                current = other.current;
-            }
-            return *this;
-		}
+        void avanza(){
+            riga_attivita r;
 
-		~const_iterator() {}
+            if(_lettore->prossima(r)){
+                _corrente.titolo.assign(r.titolo, r.lunghezza);
+                _corrente.ora_inizio = r.ora_inizio;
+                _corrente.ora_fine = r.ora_fine;
+            }
+            else
+                _lettore = nullptr;
+        }
 
-		// Ritorna il dato riferito dall'iteratore (dereferenziamento)
-		reference operator*() const {
-			return current->value;
-		}
+        public:
 
-		// Ritorna il puntatore al dato riferito dall'iteratore
-		pointer operator->() const {
-			return &(current->value);
-		}
-		
-		// Operatore di iterazione post-incremento
-		const_iterator operator++(int) {
-			const_iterator tmp(*this);
-            current = current->next;
-            return tmp;
-		}
+        typedef std::input_iterator_tag iterator_category;
+        typedef Attivita value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Attivita* pointer;
+        typedef const Attivita& reference;
 
-		// Operatore di iterazione pre-incremento
-		const_iterator& operator++() {
-			current = current->next;
-            return *this;
-		}
+        /**
+            Costruttore di default, crea l'iteratore di fine
+        */
+        iterator() : _lettore(nullptr), _corrente() {}
 
-		// Uguaglianza
-		bool operator==(const const_iterator &other) const {
-			return current == other.current;
-		}
-		
-		// Diversita'
-		bool operator!=(const const_iterator &other) const {
-			return current != other.current;
-		}
+        /**
+            Costruttore, legge la prima Attivita
 
-		
-		friend class iterator;
+            @param lettore lettore da cui leggere
+            @throw std::runtime_error se la riga è malformata
+        */
+        explicit iterator(lettore_attivita &lettore) : _lettore(&lettore), _corrente() {
+            avanza();
+        }
 
-		// Uguaglianza
-		bool operator==(const iterator &other) const {
-			return current == other.current;
-		}
+        reference operator*() const {
+            return _corrente;
+        }
 
-		// Diversita'
-		bool operator!=(const iterator &other) const {
-			return current != other.current;
-		}
+        pointer operator->() const {
+            return &_corrente;
+        }
 
-		// Costruttore di conversione iterator -> const_iterator
-		const_iterator(const iterator &other) : current(other.current) {}
+        /**
+            @brief Legge l'Attivita successiva
 
-		// Assegnamento di un iterator ad un const_iterator
-		const_iterator &operator=(const iterator &other) {
-			current = other.current;
+            @throw std::runtime_error se la riga è malformata
+        */
+        iterator& operator++() {
+            avanza();
             return *this;
-		}
+        }
 
+        iterator operator++(int) {
+            iterator tmp(*this);
+            avanza();
+            return tmp;
+        }
 
-	private:
-		const node* current; //Dati membro
-		
-		friend class set; // !!! Da cambiare il nome!
+        bool operator==(const iterator &other) const {
+            return _lettore == other._lettore;
+        }
 
-		// Costruttore privato di inizializzazione usato dalla classe container
-		// tipicamente nei metodi begin e end
-		const_iterator(const node* n) : current(n) {}
-		
-	}; // classe const_iterator
-	
-	/** 
-        @brief Restituisce un iteratore costante all'inzio del set
+        bool operator!=(const iterator &other) const {
+            return _lettore != other._lettore;
+        }
+    };
 
-        @return iteratore costante al primo elemento
-    */
-	const_iterator begin() const {
-		return const_iterator(_head);
-	}
-	
-	/** 
-        @brief Restituisce un iteratore costante alla fine del set
+    /**
+        Costruttore, apre il file
 
-        L'iteratore restituito non fa riferimento ad alcun elemento
+        Se il file non può essere aperto il lettore è vuoto e aperto()
+        restituisce false.
 
-        @return iteratore costante alla fine del set.
+        @param filename nome del file di input
     */
-	const_iterator end() const {
-		return const_iterator(nullptr);
-	}	
-//}; // CLASSE_CONTAINER_PADRE
-};
+    explicit lettore_attivita(const std::string &filename)
+        : _file(filename.c_str(), std::ios::in | std::ios::binary), _filename(filename),
+          _dati(nullptr), _pos(0), _pieni(0), _ultimo(true), _riga(0) {
+        if(_file){
+            _buffer.resize(BLOCCO);
+            _dati = _buffer.data();
+            _ultimo = false;
+        }
+    }
 
-/** 
-    @brief Operatore di output per il set
+    /**
+        Costruttore, analizza un intervallo di memoria senza copiarlo
 
-    @tparam T tipo degli elementi del set
-    @param os flusso di output
-    @param s set da stampare
-    @return riferimento al flusso di output
-*/
-template <typename T>
-std::ostream &operator<<(std::ostream &os, const set<T> &s){
-    
-    typename set<T>::node *curr = s._head;
+        I numeri di riga sono contati dall'inizio dell'intervallo.
 
-    os << "{";
+        @param inizio inizio dell'intervallo
+        @param fine fine dell'intervallo
+        @param filename nome usato nei messaggi di errore
+        @pre l'intervallo resta valido per tutta la vita del lettore
+    */
+    lettore_attivita(const char *inizio, const char *fine, const std::string &filename)
+        : _filename(filename), _dati(inizio), _pos(0),
+          _pieni(static_cast<std::size_t>(fine - inizio)), _ultimo(true), _riga(0) {}
 
-    while(curr != nullptr){
-        os << curr->value;
-        if(curr->next != nullptr)
-            os << ", ";
-        curr = curr->next;
+    /**
+        @brief Indica se il file è stato aperto
+
+        È sempre true per un lettore costruito su un intervallo di memoria.
+    */
+    bool aperto() const {
+        return _file.is_open() || _dati != nullptr;
     }
 
-    os << "}";
-    return os;
+    /**
+        @brief Numero dell'ultima riga letta (a partire da 1)
+    */
+    unsigned long riga() const {
+        return _riga;
+    }
 
-}
+    /**
+        @brief Legge la riga successiva
 
-/** 
-    @brief Operatore di unione tra due set
+        Il titolo di r punta nel buffer del lettore ed è valido
+        solo fino alla chiamata successiva.
 
-    Restituisce un nuovo set contenente tutti gli elementi presenti
-    in almeno uno dei due set passati come parametro. L'operatore non modifica i set originali.
+        @param r campi letti
+        @return false se il file è terminato (o non è stato aperto), true altrimenti
+        @throw std::runtime_error se la riga è malformata
+    */
+    bool prossima(riga_attivita &r){
+        while(true){
+            const char *inizio = _dati;
+            const char *p = inizio + _pos;
+            const char *fine = inizio + _pieni;
+            const char *eol = (p == fine) ? nullptr : static_cast<const char*>(std::memchr(p, '\n', fine - p));
+
+            if(eol == nullptr){
+                if(!_ultimo){
+                    riempi(); // riga incompleta, verrà completata dal blocco successivo
+                    continue;
+                }
+                if(p == fine)
+                    return false;
+                eol = fine;
+            }
 
-    @tparam T tipo degli elementi contenuti nei set
-    @param s1 primo set
-    @param s2 secondo set
-    @return nuovo set risultato dell'unione di s1 e s2
-*/
-template<typename T>
-set<T> operator+(const set<T>& s1, const set<T>& s2){
+            ++_riga;
+            _pos = (eol == fine) ? _pieni : static_cast<std::size_t>(eol + 1 - inizio);
 
-    set<T> risultato(s1); 
+            bool vuota = (eol == p) || (eol - p == 1 && *p == '\r');
+            if(vuota)
+                continue;
 
-    typename set<T>::const_iterator it = s2.begin();
-    typename set<T>::const_iterator it_end = s2.end();
+            if(!parse_riga_attivita(p, eol, r))
+                throw std::runtime_error(errore_riga(_filename, _riga));
+            return true;
+        }
+    }
 
-    while(it != it_end){
-        risultato.add(*it);
-        ++it;
+    /**
+        @brief Iteratore alla prima Attivita non ancora letta
+
+        @throw std::runtime_error se la riga è malformata
+    */
+    iterator begin(){
+        return iterator(*this);
     }
 
-    return risultato;
-}
+    /**
+        @brief Iteratore di fine
+    */
+    iterator end(){
+        return iterator();
+    }
+};
 
 /** 
-    @brief Filtra gli elementi del set secondo un predicato
+    @brief Legge le Attivita da un file
 
-    @tparam T tipo degli elementi
-    @tparam Predicato tipo del predicato
-    @param s set di partenza
-    @param P predicato di filtraggio
-    @return nuovo set contenente gli elementi che soddisfano il predicato
+    Passa al funtore ogni riga letta da un lettore_attivita, senza costruire
+    oggetti Attivita intermedi. È condivisa da load() per tutti i
+    contenitori di Attivita e può essere usata per contare o aggregare
+    le attività di un file senza caricarlo in memoria.
+
+    @tparam Inserisci funtore chiamato con ogni riga_attivita letta
+    @param filename nome del file di input
+    @param inserisci funtore chiamato per ogni attività
+    @return false se il file non può essere aperto, true altrimenti
+    @throw std::runtime_error se una riga è malformata
 */
-template <typename T, typename Predicato>
-set<T> filter_out(const set<T>& s, Predicato P){
+template<typename Inserisci>
+bool read_attivita(const std::string &filename, Inserisci &inserisci){
+    lettore_attivita lettore(filename);
 
-    set<T> risultato;
+    if(!lettore.aperto())
+        return false;
 
-    typename set<T>::const_iterator it = s.begin();
-    typename set<T>::const_iterator it_end = s.end();
+    riga_attivita r;
+    while(lettore.prossima(r))
+        inserisci(r);
 
-    while(it != it_end){
-        if(P(*it)){
-            risultato.add(*it);
-        }
+    return true;
+}
 
-        ++it;
-    }
+/** 
+    @brief Funtore che inserisce le Attivita lette in un set
 
-    return risultato;
-}
+    L'attività viene costruita direttamente nel nodo del set.
+*/
+struct inserisci_in_set{
+    set<Attivita> *s;
+
+    void operator()(const riga_attivita &r) const{
+        s->emplace(titolo_attivita(std::string_view(r.titolo, r.lunghezza)), r.ora_inizio, r.ora_fine);
+    }
+};
 
 /** 
     @brief Salva il contenuto di un set di Attivita su file 
 
     Scrive ogni elemento del set su una riga del file, 
     utilizzando il carattere ';' come separatore tra i campi. 
+    Per default il file viene prima scritto in un file temporaneo e poi
+    rinominato, così un salvataggio interrotto non corrompe il file esistente.
 
     @param s set di Attività da salvare
     @param filename nome del file di output
-    @param std::runtime_error se il file non può essere aperto
+    @param atomico true (default) per scrivere su un file temporaneo e poi rinominarlo
+    @param std::runtime_error se il file non può essere aperto o scritto
+*/
+inline void save(const set<Attivita> &s, const std::string &filename, bool atomico = true){
+    save_attivita(s, filename, atomico);
+}
+
+/** 
+    @brief Carica il contenuto di un set di Attività da file
+
+    Se esiste il file, il contenuto del set passato come parametro viene
+    sostituito con i dati letti dal file.
+    Se il file non esiste o non è accessibile, la funzione termina. 
+    Se una riga è malformata viene sollevata un'eccezione che ne indica
+    il numero e il set rimane invariato.
+
+    @param filename nome del file di input
+    @param s set di Attivita in cui caricare i dati
+    @throw std::runtime_error se una riga del file è malformata
 */
-void save(const set<Attivita> &s, const std::string &filename){
-    std::ofstream file(filename.c_str());
+inline void load(const std::string &filename, set<Attivita> &s){
+    set<Attivita> temp;
+    inserisci_in_set inserisci = { &temp };
 
-    if(!file)
-        throw std::runtime_error("Errore apertura file");
+    if(!read_attivita(filename, inserisci))
+        return; // se il file non esiste non fa nulla
+
+    s.swap(temp);
+}
+
+/** 
+    @brief Risultato dell'analisi di un blocco in load_parallel()
+*/
+struct blocco_attivita{
+    const char *inizio; // inizio del blocco, subito dopo un '\n'
+    const char *fine; // fine del blocco, subito dopo un '\n' o a fine file
+    set<Attivita> parziale; // attività lette dal blocco
+    unsigned long righe; // righe lette dal blocco
+    unsigned long riga_errata; // riga malformata nel blocco (0 = nessuna)
+    std::exception_ptr errore; // altra eccezione sollevata durante l'analisi
+};
+
+/** 
+    @brief Analizza un blocco del file in un set locale al thread
 
-    for(set<Attivita>::const_iterator it = s.begin(); it != s.end(); ++it){
+    Le eccezioni non vengono propagate: sono registrate nel blocco
+    e sollevate da load_parallel() nell'ordine del file.
 
-        file << it->titolo << ";"
-             << it->ora_inizio << ";"
-             << it->ora_fine << std::endl;
+    @param b blocco da analizzare
+    @param filename nome del file, usato nei messaggi di errore
+*/
+inline void analizza_blocco(blocco_attivita &b, const std::string &filename){
+    lettore_attivita lettore(b.inizio, b.fine, filename);
+
+    try{
+        riga_attivita r;
+        while(lettore.prossima(r))
+            b.parziale.emplace(titolo_attivita(std::string_view(r.titolo, r.lunghezza)), r.ora_inizio, r.ora_fine);
+    }catch(const std::runtime_error &){
+        b.riga_errata = lettore.riga();
+    }catch(...){
+        b.errore = std::current_exception();
     }
+
+    b.righe = lettore.riga();
 }
 
 /** 
-    @brief Carica il contenuto di un set di Attività da file
+    @brief Carica il contenuto di un set di Attività da file usando più thread
 
-    Se esiste il file, il set passato come parametro viene prima svuotato
-    e successivamente riempito con i dati letti dal file
-    Se il file non esiste o non è accessibile, la funzione termina. 
+    Il file viene letto in memoria e diviso in blocchi di dimensione simile,
+    spezzati solo dopo un '\n'. Ogni thread analizza un blocco in un set
+    locale e i set parziali vengono poi uniti con set::merge nell'ordine
+    dei blocchi, senza copiare le Attività. Il risultato è lo stesso di
+    load(), compreso l'ordine degli elementi e l'eliminazione dei duplicati.
+    Se più righe sono malformate viene segnalata la prima del file.
 
     @param filename nome del file di input
     @param s set di Attivita in cui caricare i dati
+    @param thread numero di thread (0 = quelli disponibili sulla macchina)
+    @throw std::runtime_error se una riga del file è malformata
+    @throw std::system_error se un thread non può essere avviato
 */
-void load(const std::string &filename, set<Attivita> &s){
-    std::ifstream file(filename.c_str());
+inline void load_parallel(const std::string &filename, set<Attivita> &s, unsigned int thread = 0){
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
 
     if(!file)
         return; // se il file non esiste non fa nulla
 
-    s.clear();
+    file.seekg(0, std::ios::end);
+    std::streamoff dimensione = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    std::vector<char> dati(dimensione > 0 ? static_cast<std::size_t>(dimensione) : 0);
+    if(!dati.empty() && !file.read(&dati[0], dimensione))
+        throw std::runtime_error("Errore lettura file " + filename);
+
+    if(thread == 0)
+        thread = std::max(1u, std::thread::hardware_concurrency());
+
+    const char *inizio = dati.data();
+    const char *fine = inizio + dati.size();
+
+    // divisione in blocchi, ognuno termina subito dopo un '\n'
+    std::vector<blocco_attivita> blocchi(thread);
+    const char *p = inizio;
+    for(unsigned int i = 0; i < thread; ++i){
+        const char *limite = fine;
+
+        if(i + 1 < thread){
+            limite = inizio + dati.size() * (i + 1) / thread;
+            if(limite <= p)
+                limite = p; // il blocco precedente ha già superato questo punto
+            else{
+                const char *eol = static_cast<const char*>(std::memchr(limite - 1, '\n', fine - (limite - 1)));
+                limite = (eol == nullptr) ? fine : eol + 1;
+            }
+        }
+
+        blocchi[i].inizio = p;
+        blocchi[i].fine = limite;
+        blocchi[i].righe = 0;
+        blocchi[i].riga_errata = 0;
+        p = limite;
+    }
 
-    std::string titolo;
-    int ora_inizio;
-    int ora_fine;
-    char separatore; // (;)
+    std::vector<std::thread> threads;
+    try{
+        for(unsigned int i = 1; i < thread; ++i)
+            threads.push_back(std::thread(analizza_blocco, std::ref(blocchi[i]), std::cref(filename)));
+    }catch(...){
+        for(std::size_t i = 0; i < threads.size(); ++i)
+            threads[i].join();
+        throw;
+    }
 
-    while(std::getline(file, titolo, ';')){
-        file >> ora_inizio;
-        file >> separatore;
-        file >> ora_fine;
-        file.ignore(); // salta il newline
-        
-        Attivita a;
-        a.titolo = titolo;
-        a.ora_inizio = ora_inizio;
-        a.ora_fine = ora_fine;
+    analizza_blocco(blocchi[0], filename);
+
+    for(std::size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
 
-        s.add(a);
+    // la prima riga malformata del file è nel primo blocco con un errore
+    unsigned long righe_precedenti = 0;
+    for(unsigned int i = 0; i < thread; ++i){
+        if(blocchi[i].riga_errata != 0)
+            throw std::runtime_error(errore_riga(filename, righe_precedenti + blocchi[i].riga_errata));
+        if(blocchi[i].errore)
+            std::rethrow_exception(blocchi[i].errore);
+        righe_precedenti += blocchi[i].righe;
     }
+
+    set<Attivita> temp;
+    for(unsigned int i = 0; i < thread; ++i)
+        temp.merge(blocchi[i].parziale);
+
+    s.swap(temp);
+}
+
+/** 
+    @brief Carica da file solo le Attività che soddisfano un predicato
+
+    Il file viene letto a flusso: le Attività scartate non vengono mai
+    inserite, quindi la memoria usata dipende solo da quelle tenute.
+    Come per load(), se il file non esiste la funzione termina e
+    se una riga è malformata il set rimane invariato.
+
+    @tparam Predicato funtore chiamato con const Attivita&
+    @param filename nome del file di input
+    @param s set di Attivita in cui caricare i dati
+    @param P predicato che indica le Attività da tenere
+    @throw std::runtime_error se una riga del file è malformata
+*/
+template<typename Predicato>
+void load_filtered(const std::string &filename, set<Attivita> &s, Predicato P){
+    lettore_attivita lettore(filename);
+
+    if(!lettore.aperto())
+        return; // se il file non esiste non fa nulla
+
+    set<Attivita> temp;
+
+    for(lettore_attivita::iterator it = lettore.begin(); it != lettore.end(); ++it){
+        if(P(*it))
+            temp.add(*it);
+    }
+
+    s.swap(temp);
 }
 
-#endif
\ No newline at end of file
+#endif
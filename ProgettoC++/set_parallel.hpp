@@ -0,0 +1,202 @@
+/**
+    @file set_parallel.hpp
+
+    @brief Versioni parallele di filter_out e delle operazioni tra set
+
+    Questo file contiene le versioni di filter_out, unione e intersezione
+    che accettano una politica di esecuzione (sequenziale o parallela).
+    Con la politica parallela il set di partenza viene diviso in blocchi
+    di elementi consecutivi, ogni blocco costruisce un set parziale su un
+    thread del pool e i set parziali vengono uniti con set::merge
+    nell'ordine dei blocchi, senza copiare di nuovo gli elementi.
+    Il risultato è identico a quello della versione sequenziale,
+    compreso l'ordine degli elementi.
+*/
+#ifndef SET_PARALLEL_HPP
+#define SET_PARALLEL_HPP
+
+#include <cstddef> // std::size_t
+#include <vector>
+#include <algorithm> // std::min
+#include "set.hpp"
+#include "thread_pool.hpp"
+
+/**
+    @brief Aggiunge a un set, in parallelo, gli elementi di s che soddisfano tieni
+
+    Gli elementi tenuti vengono aggiunti a risultato nell'ordine in cui
+    compaiono in s, come farebbe un ciclo sequenziale con add.
+    Ogni blocco usa una propria copia di tieni.
+
+    @tparam T tipo degli elementi
+    @tparam H funtore di hashing del set
+    @tparam A allocatore del set
+    @tparam Tieni predicato che indica gli elementi da aggiungere
+    @param politica pool e dimensione minima dei blocchi
+    @param s set da scorrere
+    @param tieni predicato, chiamato in modo concorrente
+    @param risultato set a cui aggiungere gli elementi
+    @throw l'eccezione sollevata dal primo blocco che fallisce
+*/
+template<typename T, typename H, typename A, typename Tieni>
+void aggiungi_in_parallelo(const politica_parallela &politica, const set<T, H, A> &s,
+                           const Tieni &tieni, set<T, H, A> &risultato){
+    typedef typename set<T, H, A>::const_iterator const_iterator;
+
+    const std::size_t dimensione = std::max<std::size_t>(1, politica.dimensione_blocco);
+    std::size_t blocchi = (s.size() + dimensione - 1) / dimensione;
+    blocchi = std::min(blocchi, politica.pool->size() * 4);
+
+    if(blocchi <= 1){
+        for(const_iterator it = s.begin(); it != s.end(); ++it){
+            if(tieni(*it))
+                risultato.add(*it);
+        }
+        return;
+    }
+
+    // confini dei blocchi, trovati con una sola visita della lista
+    std::vector<const_iterator> confini;
+    confini.reserve(blocchi + 1);
+
+    const_iterator it = s.begin();
+    for(std::size_t i = 0; i < blocchi; ++i){
+        confini.push_back(it);
+        std::size_t passi = s.size() * (i + 1) / blocchi - s.size() * i / blocchi;
+        for(std::size_t k = 0; k < passi; ++k)
+            ++it;
+    }
+    confini.push_back(it);
+
+    std::vector<set<T, H, A> > parziali(blocchi);
+
+    auto blocco = [&](std::size_t i){
+        Tieni t(tieni);
+        for(const_iterator j = confini[i]; j != confini[i + 1]; ++j){
+            if(t(*j))
+                parziali[i].add(*j);
+        }
+    };
+
+    politica.pool->esegui_blocchi(blocchi, blocco);
+
+    for(std::size_t i = 0; i < blocchi; ++i)
+        risultato.merge(parziali[i]);
+}
+
+/**
+    @brief Predicato di appartenenza a un set, usato da unione e intersezione
+*/
+template<typename T, typename H, typename A>
+struct contenuto_in{
+    const set<T, H, A> *s;
+    bool atteso; // true per tenere gli elementi contenuti, false per gli altri
+
+    bool operator()(const T &value) const{
+        return s->contains(value) == atteso;
+    }
+};
+
+/**
+    @brief Predicato sempre vero
+*/
+struct tutti{
+    template<typename T>
+    bool operator()(const T &) const{
+        return true;
+    }
+};
+
+/**
+    @brief filter_out con politica sequenziale
+*/
+template<typename T, typename H, typename A, typename Predicato>
+set<T, H, A> filter_out(politica_sequenziale, const set<T, H, A> &s, Predicato P){
+    return filter_out(s, P);
+}
+
+/**
+    @brief filter_out eseguita in parallelo
+
+    Il predicato viene copiato per ogni blocco e chiamato in modo
+    concorrente, quindi non deve modificare dati condivisi.
+
+    @tparam T tipo degli elementi
+    @tparam H funtore di hashing del set
+    @tparam A allocatore del set
+    @tparam Predicato tipo del predicato
+    @param politica politica di esecuzione parallela
+    @param s set di partenza
+    @param P predicato di filtraggio
+    @return nuovo set contenente gli elementi che soddisfano il predicato
+    @throw l'eccezione sollevata dal predicato nel primo blocco che fallisce
+*/
+template<typename T, typename H, typename A, typename Predicato>
+set<T, H, A> filter_out(const politica_parallela &politica, const set<T, H, A> &s, Predicato P){
+    set<T, H, A> risultato;
+    aggiungi_in_parallelo(politica, s, P, risultato);
+    return risultato;
+}
+
+/**
+    @brief Unione con politica sequenziale, equivalente a s1 + s2
+*/
+template<typename T, typename H, typename A>
+set<T, H, A> unione(politica_sequenziale, const set<T, H, A> &s1, const set<T, H, A> &s2){
+    return s1 + s2;
+}
+
+/**
+    @brief Unione eseguita in parallelo
+
+    Copia in parallelo gli elementi di s1 e quelli di s2 non presenti in s1.
+
+    @param politica politica di esecuzione parallela
+    @param s1 primo set
+    @param s2 secondo set
+    @return nuovo set uguale a s1 + s2
+*/
+template<typename T, typename H, typename A>
+set<T, H, A> unione(const politica_parallela &politica, const set<T, H, A> &s1, const set<T, H, A> &s2){
+    set<T, H, A> risultato;
+    risultato.reserve(s1.size() + s2.size());
+
+    aggiungi_in_parallelo(politica, s1, tutti(), risultato);
+
+    contenuto_in<T, H, A> non_in_s1 = { &s1, false };
+    aggiungi_in_parallelo(politica, s2, non_in_s1, risultato);
+
+    return risultato;
+}
+
+/**
+    @brief Intersezione con politica sequenziale, equivalente a s1 - s2
+*/
+template<typename T, typename H, typename A>
+set<T, H, A> intersezione(politica_sequenziale, const set<T, H, A> &s1, const set<T, H, A> &s2){
+    return s1 - s2;
+}
+
+/**
+    @brief Intersezione eseguita in parallelo
+
+    Come operator- scorre il set più piccolo cercando ogni elemento nel più grande.
+
+    @param politica politica di esecuzione parallela
+    @param s1 primo set
+    @param s2 secondo set
+    @return nuovo set uguale a s1 - s2
+*/
+template<typename T, typename H, typename A>
+set<T, H, A> intersezione(const politica_parallela &politica, const set<T, H, A> &s1, const set<T, H, A> &s2){
+    const set<T, H, A> &piccolo = (s1.size() <= s2.size()) ? s1 : s2;
+    const set<T, H, A> &grande = (s1.size() <= s2.size()) ? s2 : s1;
+
+    set<T, H, A> risultato;
+    contenuto_in<T, H, A> in_grande = { &grande, true };
+    aggiungi_in_parallelo(politica, piccolo, in_grande, risultato);
+
+    return risultato;
+}
+
+#endif
@@ -0,0 +1,436 @@
+/**
+    @file snapshot.hpp
+
+    @brief Formato binario di snapshot per insiemi di Attivita
+
+    Questo file contiene la scrittura e la lettura di uno snapshot binario
+    versionato di un insieme di Attivita, alternativo al formato testuale
+    di save() e load(). Lo snapshot è composto da:
+    - un'intestazione di dimensione fissa (64 byte) con numero magico,
+      versione, ordine dei byte, conteggi e offset delle sezioni;
+    - i record delle attività, di 12 byte ciascuno: indice del titolo,
+      ora di inizio e ora di fine;
+    - l'indice dei titoli: numero_titoli + 1 offset a 64 bit nel testo;
+    - il testo dei titoli, ognuno memorizzato una sola volta.
+
+    Lo snapshot può essere aperto con snapshot_view, che lo mappa in memoria
+    (mmap su sistemi POSIX) e permette di accedere ai record e ai titoli
+    senza copiarli. I numeri sono memorizzati nell'ordine dei byte della
+    macchina che ha scritto il file: un file con ordine diverso viene rifiutato.
+*/
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstdint>
+#include <cstring> // std::memcpy, std::memcmp
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <stdexcept>
+#include "set.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h> // open
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close
+#define SNAPSHOT_MMAP 1
+#endif
+
+/**
+    @brief Intestazione dello snapshot
+*/
+struct intestazione_snapshot{
+    char magic[8]; // "ATTVSNAP"
+    std::uint32_t versione; // versione del formato
+    std::uint32_t ordine_byte; // 0x01020304 scritto dalla macchina di origine
+    std::uint64_t numero_attivita; // numero di record
+    std::uint64_t numero_titoli; // numero di titoli distinti
+    std::uint64_t offset_record; // offset della sezione dei record
+    std::uint64_t offset_indice; // offset dell'indice dei titoli
+    std::uint64_t offset_testo; // offset del testo dei titoli
+    std::uint64_t dimensione_testo; // byte del testo dei titoli
+};
+
+/**
+    @brief Record di un'attività nello snapshot
+*/
+struct record_snapshot{
+    std::uint32_t titolo; // indice del titolo
+    std::int32_t ora_inizio;
+    std::int32_t ora_fine;
+};
+
+static_assert(sizeof(intestazione_snapshot) == 64, "intestazione_snapshot deve essere di 64 byte");
+static_assert(sizeof(record_snapshot) == 12, "record_snapshot deve essere di 12 byte");
+
+const char SNAPSHOT_MAGIC[8] = {'A', 'T', 'T', 'V', 'S', 'N', 'A', 'P'};
+const std::uint32_t SNAPSHOT_VERSIONE = 1;
+const std::uint32_t SNAPSHOT_ORDINE_BYTE = 0x01020304;
+
+/**
+    @brief Arrotonda un offset al multiplo di 8 successivo
+*/
+inline std::uint64_t allinea_8(std::uint64_t n){
+    return (n + 7) & ~static_cast<std::uint64_t>(7);
+}
+
+/**
+    @brief Vista in sola lettura di un'attività dello snapshot
+
+    Il titolo punta direttamente nella memoria dello snapshot ed è
+    valido finché la snapshot_view che l'ha prodotta resta aperta.
+*/
+struct attivita_view{
+    std::string_view titolo;
+    int ora_inizio;
+    int ora_fine;
+
+    /**
+        @brief Copia la vista in una Attivita
+    */
+    Attivita to_attivita() const{
+        Attivita a = { titolo_attivita(titolo), ora_inizio, ora_fine };
+        return a;
+    }
+};
+
+/**
+    @brief Vista in sola lettura su un file di snapshot
+
+    All'apertura il file viene mappato in memoria (o letto in un buffer
+    dove mmap non è disponibile) e vengono validati solo l'intestazione,
+    gli offset e l'indice dei titoli: i record non vengono letti, così
+    l'apertura non dipende dal numero di attività. L'indice del titolo di
+    un record viene controllato quando il record viene letto. Dopo
+    l'apertura l'accesso a un record costa O(1) e non copia né alloca nulla.
+*/
+class snapshot_view{
+
+    const char *_dati; // inizio del file in memoria
+    std::size_t _dimensione; // dimensione del file
+    std::vector<char> _buffer; // copia del file se mmap non è disponibile
+    bool _mappato; // true se _dati è stato ottenuto con mmap
+    intestazione_snapshot _intestazione;
+    const record_snapshot *_record;
+    const std::uint64_t *_indice;
+    const char *_testo;
+
+    snapshot_view(const snapshot_view &);
+    snapshot_view& operator=(const snapshot_view &);
+
+    /**
+        @brief Rilascia la memoria del file
+    */
+    void chiudi(){
+#ifdef SNAPSHOT_MMAP
+        if(_mappato && _dati != nullptr)
+            munmap(const_cast<char*>(_dati), _dimensione);
+#endif
+        _dati = nullptr;
+        _dimensione = 0;
+        _mappato = false;
+        _buffer.clear();
+    }
+
+    /**
+        @brief Porta il file in memoria
+
+        @param filename nome del file
+        @throw std::runtime_error se il file non può essere letto
+    */
+    void apri(const std::string &filename){
+#ifdef SNAPSHOT_MMAP
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if(fd < 0)
+            throw std::runtime_error("Errore apertura file " + filename);
+
+        struct stat info;
+        if(fstat(fd, &info) != 0 || info.st_size <= 0){
+            ::close(fd);
+            throw std::runtime_error("Snapshot non valido: " + filename);
+        }
+
+        void *p = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if(p == MAP_FAILED)
+            throw std::runtime_error("Errore mmap del file " + filename);
+
+        _dati = static_cast<const char*>(p);
+        _dimensione = static_cast<std::size_t>(info.st_size);
+        _mappato = true;
+#else
+        std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+        if(!file)
+            throw std::runtime_error("Errore apertura file " + filename);
+
+        file.seekg(0, std::ios::end);
+        std::streamoff n = file.tellg();
+        file.seekg(0, std::ios::beg);
+
+        if(n <= 0)
+            throw std::runtime_error("Snapshot non valido: " + filename);
+
+        _buffer.resize(static_cast<std::size_t>(n));
+        if(!file.read(&_buffer[0], n))
+            throw std::runtime_error("Errore lettura file " + filename);
+
+        _dati = &_buffer[0];
+        _dimensione = _buffer.size();
+#endif
+    }
+
+    /**
+        @brief Controlla intestazione, sezioni e indice dei titoli
+
+        @throw std::runtime_error se lo snapshot non è valido
+    */
+    void valida(const std::string &filename){
+        const std::string errore = "Snapshot non valido: " + filename;
+
+        if(_dimensione < sizeof(intestazione_snapshot))
+            throw std::runtime_error(errore);
+
+        std::memcpy(&_intestazione, _dati, sizeof(intestazione_snapshot));
+        const intestazione_snapshot &h = _intestazione;
+
+        if(std::memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+            throw std::runtime_error(errore);
+        if(h.ordine_byte != SNAPSHOT_ORDINE_BYTE)
+            throw std::runtime_error(errore + " (ordine dei byte diverso)");
+        if(h.versione != SNAPSHOT_VERSIONE)
+            throw std::runtime_error(errore + " (versione " + std::to_string(h.versione) + " non supportata)");
+
+        const std::uint64_t n = _dimensione;
+        if(h.offset_record % 8 != 0 || h.offset_indice % 8 != 0 ||
+           h.offset_record > n || h.numero_attivita > (n - h.offset_record) / sizeof(record_snapshot) ||
+           h.offset_indice > n || h.numero_titoli >= (n - h.offset_indice) / sizeof(std::uint64_t) ||
+           h.offset_testo > n || h.dimensione_testo > n - h.offset_testo)
+            throw std::runtime_error(errore);
+
+        _record = reinterpret_cast<const record_snapshot*>(_dati + h.offset_record);
+        _indice = reinterpret_cast<const std::uint64_t*>(_dati + h.offset_indice);
+        _testo = _dati + h.offset_testo;
+
+        if(_indice[0] != 0 || _indice[h.numero_titoli] != h.dimensione_testo)
+            throw std::runtime_error(errore);
+        for(std::uint64_t i = 0; i < h.numero_titoli; ++i){
+            if(_indice[i] > _indice[i + 1])
+                throw std::runtime_error(errore);
+        }
+    }
+
+    public:
+
+    /**
+        Costruttore, apre e valida uno snapshot
+
+        @param filename nome del file di snapshot
+        @throw std::runtime_error se il file non può essere aperto o non è valido
+    */
+    explicit snapshot_view(const std::string &filename)
+        : _dati(nullptr), _dimensione(0), _mappato(false),
+          _record(nullptr), _indice(nullptr), _testo(nullptr){
+        apri(filename);
+
+        try{
+            valida(filename);
+        }catch(...){
+            chiudi();
+            throw;
+        }
+    }
+
+    /**
+        Distruttore, rilascia la memoria del file
+    */
+    ~snapshot_view(){
+        chiudi();
+    }
+
+    /**
+        @brief Numero di attività nello snapshot
+    */
+    std::size_t size() const{
+        return static_cast<std::size_t>(_intestazione.numero_attivita);
+    }
+
+    /**
+        @brief Numero di titoli distinti nello snapshot
+    */
+    std::size_t numero_titoli() const{
+        return static_cast<std::size_t>(_intestazione.numero_titoli);
+    }
+
+    /**
+        @brief Titolo di indice i, senza copie
+
+        @param i indice del titolo
+        @return vista sul titolo
+        @pre i < numero_titoli()
+    */
+    std::string_view titolo(std::size_t i) const{
+        return std::string_view(_testo + _indice[i], static_cast<std::size_t>(_indice[i + 1] - _indice[i]));
+    }
+
+    /**
+        @brief Attività di indice i, senza copie
+
+        @param i indice dell'attività
+        @return vista sull'attività
+        @throw std::out_of_range se l'indice non è valido
+        @throw std::runtime_error se il record contiene un indice di titolo non valido
+    */
+    attivita_view operator[](std::size_t i) const{
+        if(i >= size())
+            throw std::out_of_range("Indice fuori dal range");
+
+        const record_snapshot &r = _record[i];
+        if(r.titolo >= _intestazione.numero_titoli)
+            throw std::runtime_error("Snapshot non valido: indice del titolo fuori dal range");
+
+        attivita_view a = { titolo(r.titolo), r.ora_inizio, r.ora_fine };
+        return a;
+    }
+};
+
+/**
+    @brief Scrive uno snapshot binario di un contenitore di Attivita
+
+    I titoli vengono internati: ognuno è scritto una sola volta e i record
+    ne contengono l'indice. Il file viene scritto in un file temporaneo
+    e poi rinominato, come in save().
+
+    @tparam Container contenitore di Attivita dotato di const_iterator
+    @param s contenitore di Attività da salvare
+    @param filename nome del file di snapshot
+    @throw std::runtime_error se il file non può essere scritto
+*/
+template<typename Container>
+void save_snapshot(const Container &s, const std::string &filename){
+    std::unordered_map<std::string_view, std::uint32_t> indici;
+    std::vector<std::string_view> titoli;
+    std::vector<record_snapshot> record;
+
+    for(typename Container::const_iterator it = s.begin(); it != s.end(); ++it){
+        std::string_view t(it->titolo.data(), it->titolo.size());
+        std::pair<std::unordered_map<std::string_view, std::uint32_t>::iterator, bool> ins =
+            indici.insert(std::make_pair(t, static_cast<std::uint32_t>(titoli.size())));
+        if(ins.second)
+            titoli.push_back(t);
+
+        record_snapshot r = { ins.first->second, it->ora_inizio, it->ora_fine };
+        record.push_back(r);
+    }
+
+    std::vector<std::uint64_t> indice(titoli.size() + 1, 0);
+    for(std::size_t i = 0; i < titoli.size(); ++i)
+        indice[i + 1] = indice[i] + titoli[i].size();
+
+    intestazione_snapshot h;
+    std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    h.versione = SNAPSHOT_VERSIONE;
+    h.ordine_byte = SNAPSHOT_ORDINE_BYTE;
+    h.numero_attivita = record.size();
+    h.numero_titoli = titoli.size();
+    h.offset_record = sizeof(intestazione_snapshot);
+    h.offset_indice = allinea_8(h.offset_record + record.size() * sizeof(record_snapshot));
+    h.offset_testo = h.offset_indice + indice.size() * sizeof(std::uint64_t);
+    h.dimensione_testo = indice.back();
+
+    const std::string temporaneo = nome_temporaneo(filename);
+    {
+        std::ofstream file(temporaneo.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if(!file)
+            throw std::runtime_error("Errore apertura file");
+
+        const char zeri[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        std::uint64_t fine_record = h.offset_record + record.size() * sizeof(record_snapshot);
+
+        file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        if(!record.empty())
+            file.write(reinterpret_cast<const char*>(&record[0]), record.size() * sizeof(record_snapshot));
+        file.write(zeri, static_cast<std::streamsize>(h.offset_indice - fine_record));
+        file.write(reinterpret_cast<const char*>(&indice[0]), indice.size() * sizeof(std::uint64_t));
+        for(std::size_t i = 0; i < titoli.size(); ++i)
+            file.write(titoli[i].data(), static_cast<std::streamsize>(titoli[i].size()));
+
+        file.close();
+        if(!file){
+            std::remove(temporaneo.c_str());
+            throw std::runtime_error("Errore scrittura file");
+        }
+    }
+
+    sostituisci_file(temporaneo, filename);
+}
+
+/**
+    @brief Carica in un set le attività di uno snapshot
+
+    Il contenuto del set viene sostituito solo se lo snapshot è valido.
+
+    @param filename nome del file di snapshot
+    @param s set di Attivita in cui caricare i dati
+    @throw std::runtime_error se il file non può essere aperto o non è valido
+*/
+inline void load_snapshot(const std::string &filename, set<Attivita> &s){
+    snapshot_view v(filename);
+
+    set<Attivita> temp;
+    temp.reserve(static_cast<unsigned int>(v.size()));
+
+    for(std::size_t i = 0; i < v.size(); ++i){
+        attivita_view a = v[i];
+        temp.emplace(titolo_attivita(a.titolo), a.ora_inizio, a.ora_fine);
+    }
+
+    s.swap(temp);
+}
+
+/**
+    @brief Converte un file di testo di Attivita in uno snapshot
+
+    Le righe duplicate vengono scartate come in load().
+
+    @param testo file di testo nel formato di save()
+    @param snapshot file di snapshot da scrivere
+    @throw std::runtime_error se il file di testo non esiste o è malformato
+    o se lo snapshot non può essere scritto
+*/
+inline void text_to_snapshot(const std::string &testo, const std::string &snapshot){
+    set<Attivita> s;
+    inserisci_in_set inserisci = { &s };
+
+    if(!read_attivita(testo, inserisci))
+        throw std::runtime_error("Errore apertura file " + testo);
+
+    save_snapshot(s, snapshot);
+}
+
+/**
+    @brief Converte uno snapshot nel formato di testo di save()
+
+    I record vengono scritti direttamente dalla vista sullo snapshot,
+    senza costruire un set.
+
+    @param snapshot file di snapshot da leggere
+    @param testo file di testo da scrivere
+    @throw std::runtime_error se lo snapshot non è valido o il testo non può essere scritto
+*/
+inline void snapshot_to_text(const std::string &snapshot, const std::string &testo){
+    snapshot_view v(snapshot);
+    scrittore_attivita scrittore(testo, true);
+
+    for(std::size_t i = 0; i < v.size(); ++i){
+        attivita_view a = v[i];
+        scrittore.scrivi(a.titolo.data(), a.titolo.size(), a.ora_inizio, a.ora_fine);
+    }
+
+    scrittore.chiudi();
+}
+
+#endif
@@ -0,0 +1,47 @@
+/**
+    @file snapshot_tool.cpp
+    @brief Conversione tra il formato testuale e lo snapshot binario
+
+    Uso:
+    - snapshot_tool to-bin attivita.txt attivita.bin
+    - snapshot_tool to-text attivita.bin attivita.txt
+*/
+
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include "set.hpp"
+#include "snapshot.hpp"
+
+/**
+    @brief Stampa il messaggio d'uso
+*/
+void uso(const char *programma){
+    std::cerr << "Uso: " << programma << " to-bin <file.txt> <file.bin>" << std::endl;
+    std::cerr << "     " << programma << " to-text <file.bin> <file.txt>" << std::endl;
+}
+
+int main(int argc, char *argv[]){
+    if(argc != 4){
+        uso(argv[0]);
+        return 2;
+    }
+
+    const std::string comando = argv[1];
+
+    try{
+        if(comando == "to-bin")
+            text_to_snapshot(argv[2], argv[3]);
+        else if(comando == "to-text")
+            snapshot_to_text(argv[2], argv[3]);
+        else{
+            uso(argv[0]);
+            return 2;
+        }
+    }catch(const std::exception &e){
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,349 @@
+/**
+    @file thread_pool.hpp
+
+    @brief Pool di thread con work stealing
+
+    Questo file contiene la classe thread_pool, un insieme di thread
+    creati una sola volta e riutilizzati per eseguire compiti brevi,
+    e le politiche di esecuzione usate dagli algoritmi paralleli su set.
+
+    Ogni thread ha una propria coda di compiti: prende il più recente dalla
+    propria coda e, quando è vuota, ruba il più vecchio dalle code degli altri.
+    Il thread che attende la fine di un gruppo di compiti partecipa
+    all'esecuzione, quindi i compiti possono a loro volta usare il pool.
+*/
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <cstddef> // std::size_t
+#include <algorithm> // std::max
+#include <deque>
+#include <vector>
+#include <memory> // std::unique_ptr
+#include <functional> // std::function
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception> // std::exception_ptr
+
+/**
+    @brief Pool di thread con una coda di compiti per thread
+*/
+class thread_pool{
+
+    /**
+        @brief Coda di compiti di un thread
+    */
+    struct coda{
+        std::mutex m;
+        std::deque<std::function<void()> > compiti;
+    };
+
+    std::vector<std::unique_ptr<coda> > _code; // una coda per thread
+    std::vector<std::thread> _thread;
+    std::mutex _m; // protegge l'attesa dei thread senza lavoro
+    std::condition_variable _cv;
+    std::atomic<std::size_t> _in_coda; // compiti non ancora presi
+    std::atomic<std::size_t> _prossima; // coda a cui accodare i compiti esterni
+    bool _fermo; // true quando il pool viene distrutto
+
+    /**
+        @brief Indice del thread corrente nel pool a cui appartiene
+
+        Vale -1 per i thread che non appartengono a un pool.
+    */
+    static int& indice_corrente(){
+        static thread_local int indice = -1;
+        return indice;
+    }
+
+    /**
+        @brief Pool a cui appartiene il thread corrente (nullptr se nessuno)
+    */
+    static thread_pool*& pool_corrente(){
+        static thread_local thread_pool *pool = nullptr;
+        return pool;
+    }
+
+    thread_pool(const thread_pool &);
+    thread_pool& operator=(const thread_pool &);
+
+    /**
+        @brief Prende un compito, prima dalla coda i e poi da quelle degli altri
+
+        @param i coda da cui partire
+        @param compito compito preso
+        @return true se è stato preso un compito, false se le code sono vuote
+    */
+    bool prendi(std::size_t i, std::function<void()> &compito){
+        const std::size_t n = _code.size();
+
+        // dalla propria coda si prende il compito più recente
+        {
+            coda &c = *_code[i];
+            std::lock_guard<std::mutex> lock(c.m);
+            if(!c.compiti.empty()){
+                compito = std::move(c.compiti.back());
+                c.compiti.pop_back();
+                --_in_coda;
+                return true;
+            }
+        }
+
+        // dalle altre code si ruba il compito più vecchio
+        for(std::size_t k = 1; k < n; ++k){
+            coda &c = *_code[(i + k) % n];
+            std::lock_guard<std::mutex> lock(c.m);
+            if(!c.compiti.empty()){
+                compito = std::move(c.compiti.front());
+                c.compiti.pop_front();
+                --_in_coda;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+        @brief Ciclo di lavoro di un thread del pool
+
+        @param i indice del thread e della sua coda
+    */
+    void lavora(std::size_t i){
+        indice_corrente() = static_cast<int>(i);
+        pool_corrente() = this;
+
+        std::function<void()> compito;
+
+        while(true){
+            if(prendi(i, compito)){
+                compito();
+                compito = nullptr;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(_m);
+            _cv.wait(lock, [this]{ return _fermo || _in_coda > 0; });
+            if(_fermo && _in_coda == 0)
+                return;
+        }
+    }
+
+    public:
+
+    /**
+        Costruttore, avvia i thread del pool
+
+        @param n numero di thread (0 = quelli disponibili sulla macchina)
+        @throw std::system_error se un thread non può essere avviato
+    */
+    explicit thread_pool(unsigned int n = 0) : _in_coda(0), _prossima(0), _fermo(false) {
+        if(n == 0)
+            n = std::max(1u, std::thread::hardware_concurrency());
+
+        for(unsigned int i = 0; i < n; ++i)
+            _code.push_back(std::unique_ptr<coda>(new coda));
+
+        try{
+            for(unsigned int i = 0; i < n; ++i)
+                _thread.push_back(std::thread(&thread_pool::lavora, this, i));
+        }catch(...){
+            {
+                std::lock_guard<std::mutex> lock(_m);
+                _fermo = true;
+            }
+            _cv.notify_all();
+            for(std::size_t i = 0; i < _thread.size(); ++i)
+                _thread[i].join();
+            throw;
+        }
+    }
+
+    /**
+        Distruttore, esegue i compiti rimasti e ferma i thread
+    */
+    ~thread_pool(){
+        {
+            std::lock_guard<std::mutex> lock(_m);
+            _fermo = true;
+        }
+        _cv.notify_all();
+
+        for(std::size_t i = 0; i < _thread.size(); ++i)
+            _thread[i].join();
+    }
+
+    /**
+        @brief Pool condiviso dal programma
+
+        Viene creato al primo utilizzo con un thread per core
+        e riutilizzato da tutte le chiamate successive.
+    */
+    static thread_pool& globale(){
+        static thread_pool pool;
+        return pool;
+    }
+
+    /**
+        @brief Numero di thread del pool
+    */
+    std::size_t size() const{
+        return _thread.size();
+    }
+
+    /**
+        @brief Accoda un compito
+
+        Un compito accodato da un thread del pool va nella sua coda,
+        gli altri vengono distribuiti a turno tra le code.
+
+        @param compito funzione da eseguire, non deve sollevare eccezioni
+    */
+    void submit(std::function<void()> compito){
+        std::size_t i;
+        if(pool_corrente() == this)
+            i = static_cast<std::size_t>(indice_corrente());
+        else
+            i = _prossima++ % _code.size();
+
+        {
+            coda &c = *_code[i];
+            std::lock_guard<std::mutex> lock(c.m);
+            c.compiti.push_back(std::move(compito));
+            ++_in_coda;
+        }
+
+        // il lock evita che un thread si addormenti senza vedere il nuovo compito
+        {
+            std::lock_guard<std::mutex> lock(_m);
+        }
+        _cv.notify_one();
+    }
+
+    /**
+        @brief Esegue nel thread corrente un compito in attesa, se c'è
+
+        @return true se è stato eseguito un compito, false se le code sono vuote
+    */
+    bool esegui_uno(){
+        std::size_t i = (pool_corrente() == this) ? static_cast<std::size_t>(indice_corrente()) : 0;
+        std::function<void()> compito;
+
+        if(!prendi(i, compito))
+            return false;
+
+        compito();
+        return true;
+    }
+
+    /**
+        @brief Esegue f(0), ..., f(n - 1) sul pool e ne attende la fine
+
+        Il blocco 0 viene eseguito dal thread chiamante, che poi aiuta
+        ad eseguire i compiti ancora in coda. Se più blocchi sollevano
+        un'eccezione viene rilanciata quella del blocco di indice minore.
+
+        @tparam F funtore chiamato con l'indice del blocco
+        @param n numero di blocchi
+        @param f funtore da eseguire, chiamato in modo concorrente
+        @throw l'eccezione sollevata dal primo blocco che fallisce
+    */
+    template<typename F>
+    void esegui_blocchi(std::size_t n, F &f){
+        if(n == 0)
+            return;
+
+        std::vector<std::exception_ptr> errori(n);
+        std::mutex m;
+        std::condition_variable cv;
+        std::size_t rimasti = n - 1;
+
+        for(std::size_t i = 1; i < n; ++i){
+            submit([&f, &errori, &m, &cv, &rimasti, i]{
+                try{
+                    f(i);
+                }catch(...){
+                    errori[i] = std::current_exception();
+                }
+
+                // la notifica avviene con il lock: l'attesa non può terminare prima
+                std::lock_guard<std::mutex> lock(m);
+                if(--rimasti == 0)
+                    cv.notify_all();
+            });
+        }
+
+        try{
+            f(0);
+        }catch(...){
+            errori[0] = std::current_exception();
+        }
+
+        while(true){
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if(rimasti == 0)
+                    break;
+            }
+
+            if(esegui_uno())
+                continue;
+
+            // tutti i compiti sono già stati presi da altri thread
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&rimasti]{ return rimasti == 0; });
+            break;
+        }
+
+        for(std::size_t i = 0; i < n; ++i){
+            if(errori[i])
+                std::rethrow_exception(errori[i]);
+        }
+    }
+};
+
+/**
+    @brief Politica di esecuzione sequenziale
+
+    Gli algoritmi chiamati con questa politica usano la versione
+    a un solo thread.
+*/
+struct politica_sequenziale{};
+
+/**
+    @brief Politica di esecuzione parallela
+
+    L'insieme di partenza viene diviso in blocchi di almeno
+    dimensione_blocco elementi, eseguiti sul pool indicato.
+*/
+struct politica_parallela{
+    thread_pool *pool;
+    std::size_t dimensione_blocco;
+};
+
+const politica_sequenziale sequenziale = {};
+
+/**
+    @brief Politica parallela sul pool globale
+
+    @param dimensione_blocco numero minimo di elementi per blocco
+*/
+inline politica_parallela parallela(std::size_t dimensione_blocco = 1024){
+    politica_parallela p = { &thread_pool::globale(), dimensione_blocco };
+    return p;
+}
+
+/**
+    @brief Politica parallela su un pool indicato
+
+    @param pool pool su cui eseguire i blocchi
+    @param dimensione_blocco numero minimo di elementi per blocco
+*/
+inline politica_parallela parallela(thread_pool &pool, std::size_t dimensione_blocco = 1024){
+    politica_parallela p = { &pool, dimensione_blocco };
+    return p;
+}
+
+#endif
@@ -0,0 +1,339 @@
+/**
+    @file titolo.hpp
+
+    @brief Titoli internati per le Attivita
+
+    Questo file contiene la classe titolo_internato, usata per il titolo
+    delle Attivita. Ogni testo distinto viene memorizzato una sola volta
+    in un pool globale e il titolo contiene solo un puntatore a quella copia:
+    confronti di uguaglianza e hash lavorano sul puntatore, e milioni di
+    attività con poche centinaia di titoli diversi condividono la stessa memoria.
+
+    Il pool è condiviso da tutti i thread ed è protetto da uno std::shared_mutex:
+    la ricerca di un titolo già presente prende solo il lock in lettura.
+    Ogni thread ha inoltre una piccola cache degli ultimi titoli internati,
+    consultata senza lock.
+
+    Il pool cresce soltanto: un testo resta in memoria anche dopo che
+    l'ultimo titolo che lo usa è stato distrutto, così un titolo_internato
+    resta valido per tutta la durata del programma. Il risparmio c'è quando
+    i titoli si ripetono; con molti titoli tutti diversi ognuno costa più
+    di una std::string (la ricerca nel pool, la stringa nel pool e la voce
+    dell'indice) e la memoria non viene restituita. Per questo le Attivita
+    usano i titoli internati solo se è definito ATTIVITA_TITOLI_INTERNATI
+    (vedi titolo_attivita in set.hpp).
+*/
+#ifndef TITOLO_HPP
+#define TITOLO_HPP
+
+#include <cstddef> // std::size_t
+#include <string>
+#include <string_view>
+#include <deque>
+#include <vector>
+#include <shared_mutex>
+#include <mutex> // std::unique_lock
+#include <ostream>
+#include <functional> // std::hash
+
+/**
+    @brief Titolo di un'attività memorizzato nel pool dei titoli
+
+    Si converte implicitamente da e verso std::string, quindi può essere
+    usato al posto di una stringa nella maggior parte dei casi.
+    L'ordinamento (compare) segue quello delle stringhe.
+*/
+class titolo_internato{
+
+    const std::string *_testo; // copia del testo nel pool o testo vuoto, mai nullptr
+
+    /**
+        @brief Voce della tabella del pool e della cache dei thread
+    */
+    struct voce{
+        std::size_t hash;
+        const std::string *testo; // nullptr = voce libera
+    };
+
+    /**
+        @brief Pool globale dei titoli
+
+        Le stringhe sono in una deque, che non le sposta quando cresce.
+        L'indice è una tabella hash ad indirizzamento aperto (probing lineare)
+        con fattore di carico al massimo 1/2, come quella di set.
+    */
+    struct pool_titoli{
+        std::shared_mutex m;
+        std::deque<std::string> testi;
+        std::vector<voce> indice; // capacità 0 o potenza di 2
+
+        /**
+            @brief Cerca un testo nell'indice
+
+            @return puntatore al testo, nullptr se non è presente
+        */
+        const std::string* cerca(std::string_view s, std::size_t h) const{
+            if(indice.empty())
+                return nullptr;
+
+            std::size_t mask = indice.size() - 1;
+            for(std::size_t i = h & mask; indice[i].testo != nullptr; i = (i + 1) & mask){
+                if(indice[i].hash == h && *indice[i].testo == s)
+                    return indice[i].testo;
+            }
+
+            return nullptr;
+        }
+
+        /**
+            @brief Aggiunge un testo non presente
+
+            @return puntatore alla copia del testo nel pool
+            @throw std::bad_alloc possibile eccezione di allocazione
+        */
+        const std::string* aggiungi(std::string_view s, std::size_t h){
+            if((testi.size() + 1) * 2 > indice.size()){
+                std::vector<voce> nuovo(indice.empty() ? 64 : indice.size() * 2, voce());
+                std::size_t mask = nuovo.size() - 1;
+
+                for(std::size_t j = 0; j < indice.size(); ++j){
+                    if(indice[j].testo == nullptr)
+                        continue;
+                    std::size_t i = indice[j].hash & mask;
+                    while(nuovo[i].testo != nullptr)
+                        i = (i + 1) & mask;
+                    nuovo[i] = indice[j];
+                }
+
+                indice.swap(nuovo);
+            }
+
+            testi.push_back(std::string(s));
+
+            std::size_t mask = indice.size() - 1;
+            std::size_t i = h & mask;
+            while(indice[i].testo != nullptr)
+                i = (i + 1) & mask;
+
+            indice[i].hash = h;
+            indice[i].testo = &testi.back();
+
+            return indice[i].testo;
+        }
+    };
+
+    static const std::size_t DIMENSIONE_CACHE = 256;
+
+    /**
+        @brief Restituisce il pool, creato al primo utilizzo
+
+        Il pool non viene mai distrutto, così i titoli restano validi
+        anche durante la distruzione degli oggetti statici.
+    */
+    static pool_titoli& pool(){
+        static pool_titoli *p = new pool_titoli;
+        return *p;
+    }
+
+    /**
+        @brief Cache dei titoli internati dal thread corrente
+
+        Tabella a indirizzamento diretto sull'hash del testo.
+    */
+    static voce* cache(){
+        static thread_local voce c[DIMENSIONE_CACHE] = {};
+        return c;
+    }
+
+    /**
+        @brief Cerca un testo nel pool, aggiungendolo se manca
+
+        L'hash del testo viene calcolato una sola volta e usato sia
+        per la cache del thread sia per l'indice del pool.
+
+        @param s testo da cercare
+        @return puntatore alla copia del testo nel pool
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    static const std::string* interna(std::string_view s){
+        if(s.empty())
+            return vuoto();
+
+        const std::size_t h = std::hash<std::string_view>()(s);
+
+        voce &c = cache()[h & (DIMENSIONE_CACHE - 1)];
+        if(c.testo != nullptr && c.hash == h && *c.testo == s)
+            return c.testo;
+
+        pool_titoli &p = pool();
+        const std::string *testo;
+
+        {
+            std::shared_lock<std::shared_mutex> lock(p.m);
+            testo = p.cerca(s, h);
+        }
+
+        if(testo == nullptr){
+            std::unique_lock<std::shared_mutex> lock(p.m);
+
+            // un altro thread può averlo aggiunto nel frattempo
+            testo = p.cerca(s, h);
+            if(testo == nullptr)
+                testo = p.aggiungi(s, h);
+        }
+
+        c.hash = h;
+        c.testo = testo;
+
+        return testo;
+    }
+
+    /**
+        @brief Titolo vuoto, usato dal costruttore di default
+
+        Non sta nel pool, così costruire un titolo vuoto non prende lock.
+    */
+    static const std::string* vuoto(){
+        static const std::string *v = new std::string;
+        return v;
+    }
+
+    public:
+
+    /**
+        Costruttore di default, titolo vuoto
+    */
+    titolo_internato() : _testo(vuoto()) {}
+
+    /**
+        Costruttori di conversione, internano il testo
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    titolo_internato(const std::string &s) : _testo(interna(s)) {}
+
+    titolo_internato(const char *s) : _testo(interna(s)) {}
+
+    titolo_internato(std::string_view s) : _testo(interna(s)) {}
+
+    /**
+        @brief Sostituisce il titolo con il testo indicato
+
+        @param s inizio del testo
+        @param n lunghezza del testo
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void assign(const char *s, std::size_t n){
+        _testo = interna(std::string_view(s, n));
+    }
+
+    /**
+        @brief Testo del titolo
+    */
+    const std::string& str() const{
+        return *_testo;
+    }
+
+    operator const std::string&() const{
+        return *_testo;
+    }
+
+    const char* data() const{
+        return _testo->data();
+    }
+
+    const char* c_str() const{
+        return _testo->c_str();
+    }
+
+    std::size_t size() const{
+        return _testo->size();
+    }
+
+    bool empty() const{
+        return _testo->empty();
+    }
+
+    /**
+        @brief Confronta i testi di due titoli
+
+        Titoli uguali vengono riconosciuti dal puntatore senza leggere il testo.
+
+        @return 0 se uguali, negativo se this precede other, positivo altrimenti
+    */
+    int compare(const titolo_internato &other) const{
+        return _testo == other._testo ? 0 : _testo->compare(*other._testo);
+    }
+
+    /**
+        @brief Hash del titolo, calcolato sul puntatore
+    */
+    std::size_t hash() const{
+        return std::hash<const std::string*>()(_testo);
+    }
+
+    /**
+        @brief Numero di titoli distinti nel pool, escluso il titolo vuoto
+    */
+    static std::size_t numero_titoli(){
+        pool_titoli &p = pool();
+        std::shared_lock<std::shared_mutex> lock(p.m);
+        return p.testi.size();
+    }
+
+    // Due titoli sono uguali se puntano allo stesso testo del pool
+    friend bool operator==(const titolo_internato &a, const titolo_internato &b){
+        return a._testo == b._testo;
+    }
+
+    friend bool operator!=(const titolo_internato &a, const titolo_internato &b){
+        return a._testo != b._testo;
+    }
+};
+
+// Confronti con le stringhe, senza aggiungere il testo al pool
+inline bool operator==(const titolo_internato &a, const std::string &b){
+    return a.str() == b;
+}
+
+inline bool operator==(const std::string &a, const titolo_internato &b){
+    return a == b.str();
+}
+
+inline bool operator==(const titolo_internato &a, const char *b){
+    return a.str() == b;
+}
+
+inline bool operator==(const char *a, const titolo_internato &b){
+    return a == b.str();
+}
+
+inline bool operator!=(const titolo_internato &a, const std::string &b){
+    return !(a == b);
+}
+
+inline bool operator!=(const titolo_internato &a, const char *b){
+    return !(a == b);
+}
+
+/**
+    @brief Operatore di output per i titoli, stampa il testo
+*/
+inline std::ostream& operator<<(std::ostream &os, const titolo_internato &t){
+    return os << t.str();
+}
+
+namespace std{
+
+    /**
+        @brief Specializzazione di std::hash per titolo_internato
+    */
+    template<>
+    struct hash<titolo_internato>{
+        std::size_t operator()(const titolo_internato &t) const{
+            return t.hash();
+        }
+    };
+}
+
+#endif
@@ -2,18 +2,34 @@ QT       += core gui
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
-CONFIG += c++11
+CONFIG += c++17
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    archivio.cpp \
+    indicesovrapposizioni.cpp \
+    journal.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    ricorrenza.cpp \
+    scrittoreasincrono.cpp \
+    task.cpp \
+    tasktablemodel.cpp \
+    titolo.cpp
 
 HEADERS += \
-    mainwindow.h
+    archivio.h \
+    indicesovrapposizioni.h \
+    journal.h \
+    mainwindow.h \
+    ricorrenza.h \
+    scrittoreasincrono.h \
+    task.h \
+    tasktablemodel.h \
+    titolo.h
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,352 @@
+#include "archivio.h"
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+
+void scriviTask(QTextStream &out, const QDate &data, const Task &task){
+
+    // QString e non const char*: in Qt 5 QTextStream legge i const char* come Latin-1
+    out << data.toString("yyyy-MM-dd") << ";"
+        << (task.type() == TaskType::Event ? QString("Evento") : QString("Attività")) << ";"
+        << task.title.testo() << ";"
+        << task.startTime().toString("HH:mm") << ";";
+
+    if(task.hasEndTime())
+        out << task.endTime().toString("HH:mm");
+    else
+        out << "";
+
+    out << ";" << testoFrequenza(task.frequency()) << ";"
+        << (task.completed() ? "1":"0");
+}
+
+void scriviRegola(QTextStream &out, const RegolaRicorrenza &regola){
+
+    scriviTask(out, regola.inizio, regola.base);
+    out << ";" << (regola.fine.isValid() ? regola.fine.toString("yyyy-MM-dd") : "") << ";";
+
+    QList<QDate> eccezioni = regola.eccezioni.values();
+    std::sort(eccezioni.begin(), eccezioni.end());
+    for(int j = 0; j < eccezioni.size(); ++j)
+        out << (j > 0 ? "," : "") << eccezioni[j].toString("yyyy-MM-dd");
+}
+
+// Legge un task dai campi parti[primo] ... parti[primo+6]
+bool leggiTask(const QStringList &parti, int primo, QDate &data, Task &task){
+
+    if(parti.size() < primo + 7)
+        return false;
+
+    data = QDate::fromString(parti[primo], "yyyy-MM-dd");
+
+    QTime inizio = QTime::fromString(parti[primo+3], "HH:mm");
+    QTime fine = QTime::fromString(parti[primo+4], "HH:mm");
+
+    // Task memorizza solo orari validi
+    if(!inizio.isValid() || (!parti[primo+4].isEmpty() && !fine.isValid()))
+        return false;
+
+    task.setType((parti[primo+1] == "Evento") ? TaskType::Event : TaskType::Activity);
+    task.title = Titolo(parti[primo+2]);
+    task.setStartTime(inizio);
+    task.setHasEndTime(!parti[primo+4].isEmpty());
+    if(task.hasEndTime())
+        task.setEndTime(fine);
+
+    task.setFrequency(frequenzaDaTesto(parti[primo+5]));
+    task.setCompleted(parti[primo+6] == "1");
+
+    return data.isValid();
+}
+
+// Legge una regola dai campi parti[primo] ... parti[primo+8]
+bool leggiRegola(const QStringList &parti, int primo, RegolaRicorrenza &regola){
+
+    if(parti.size() < primo + 9 || !leggiTask(parti, primo, regola.inizio, regola.base))
+        return false;
+
+    regola.fine = QDate::fromString(parti[primo+7], "yyyy-MM-dd");
+
+    QStringList eccezioni = parti[primo+8].split(",");
+    for(int i = 0; i < eccezioni.size(); ++i){
+        if(!eccezioni[i].isEmpty())
+            regola.eccezioni.insert(QDate::fromString(eccezioni[i], "yyyy-MM-dd"));
+    }
+
+    return true;
+}
+
+// Campi di una riga, come intervalli di byte della riga stessa
+struct CampiRiga{
+    static const int MASSIMO = 9;
+    const char *inizio[MASSIMO];
+    int lunghezza[MASSIMO];
+    int numero;
+};
+
+// Divide la riga sui ';', false se ha più di CampiRiga::MASSIMO campi
+static bool dividiCampi(const char *inizio, const char *fine, CampiRiga &campi){
+
+    campi.numero = 0;
+
+    while(true){
+        const char *separatore = static_cast<const char*>(memchr(inizio, ';', fine - inizio));
+        const char *fineCampo = separatore ? separatore : fine;
+
+        if(campi.numero == CampiRiga::MASSIMO)
+            return false;
+
+        campi.inizio[campi.numero] = inizio;
+        campi.lunghezza[campi.numero] = int(fineCampo - inizio);
+        ++campi.numero;
+
+        if(!separatore)
+            return true;
+
+        inizio = separatore + 1;
+    }
+}
+
+// Valore di n cifre decimali, -1 se c'è un carattere che non è una cifra
+static int leggiNumero(const char *p, int n){
+
+    int valore = 0;
+
+    for(int i = 0; i < n; ++i){
+        unsigned cifra = unsigned(p[i] - '0');
+        if(cifra > 9)
+            return -1;
+        valore = valore * 10 + int(cifra);
+    }
+
+    return valore;
+}
+
+// Data aaaa-mm-gg, non valida se il campo ha un altro formato
+static QDate leggiData(const char *p, int n){
+
+    if(n != 10 || p[4] != '-' || p[7] != '-')
+        return QDate();
+
+    int anno = leggiNumero(p, 4);
+    int mese = leggiNumero(p + 5, 2);
+    int giorno = leggiNumero(p + 8, 2);
+
+    if(anno < 0 || mese < 0 || giorno < 0)
+        return QDate();
+
+    return QDate(anno, mese, giorno);
+}
+
+// Ora hh:mm in minuti dall'inizio del giorno, -1 se il campo ha un altro formato
+static int leggiMinuti(const char *p, int n){
+
+    if(n != 5 || p[2] != ':')
+        return -1;
+
+    int ore = leggiNumero(p, 2);
+    int minuti = leggiNumero(p + 3, 2);
+
+    if(ore < 0 || ore > 23 || minuti < 0 || minuti > 59)
+        return -1;
+
+    return ore * 60 + minuti;
+}
+
+static bool uguale(const char *p, int n, const char *testo){
+    return size_t(n) == strlen(testo) && memcmp(p, testo, n) == 0;
+}
+
+// Come frequenzaDaTesto, ma sui byte del campo
+static Frequency leggiFrequenza(const char *p, int n){
+
+    if(uguale(p, n, "Giornaliera"))
+        return Frequency::Daily;
+    if(uguale(p, n, "Settimanale"))
+        return Frequency::Weekly;
+    if(uguale(p, n, "Mensile"))
+        return Frequency::Monthly;
+
+    return Frequency::None;
+}
+
+// Legge un task dai primi 7 campi
+static bool leggiCampiTask(const CampiRiga &campi, QDate &data, Task &task){
+
+    data = leggiData(campi.inizio[0], campi.lunghezza[0]);
+
+    int inizio = leggiMinuti(campi.inizio[3], campi.lunghezza[3]);
+    int fine = campi.lunghezza[4] > 0 ? leggiMinuti(campi.inizio[4], campi.lunghezza[4]) : 0;
+
+    // Task memorizza solo orari validi
+    if(inizio < 0 || fine < 0)
+        return false;
+
+    task.setType(uguale(campi.inizio[1], campi.lunghezza[1], "Evento") ? TaskType::Event : TaskType::Activity);
+    task.title = Titolo::daUtf8(campi.inizio[2], campi.lunghezza[2]);
+    task.setStartMinute(inizio);
+    task.setHasEndTime(campi.lunghezza[4] > 0);
+    task.setEndMinute(fine);
+
+    task.setFrequency(leggiFrequenza(campi.inizio[5], campi.lunghezza[5]));
+    task.setCompleted(uguale(campi.inizio[6], campi.lunghezza[6], "1"));
+
+    return data.isValid();
+}
+
+bool leggiTask(const char *inizio, const char *fine, QDate &data, Task &task){
+
+    CampiRiga campi;
+
+    if(!dividiCampi(inizio, fine, campi) || campi.numero != 7)
+        return false;
+
+    return leggiCampiTask(campi, data, task);
+}
+
+bool leggiRegola(const char *inizio, const char *fine, RegolaRicorrenza &regola){
+
+    CampiRiga campi;
+
+    if(!dividiCampi(inizio, fine, campi) || campi.numero != 9)
+        return false;
+
+    if(!leggiCampiTask(campi, regola.inizio, regola.base))
+        return false;
+
+    regola.fine = leggiData(campi.inizio[7], campi.lunghezza[7]);
+
+    // eccezioni separate da ','
+    const char *p = campi.inizio[8];
+    const char *fineEccezioni = p + campi.lunghezza[8];
+
+    while(p < fineEccezioni){
+        const char *virgola = static_cast<const char*>(memchr(p, ',', fineEccezioni - p));
+        const char *fineData = virgola ? virgola : fineEccezioni;
+
+        if(fineData > p)
+            regola.eccezioni.insert(leggiData(p, int(fineData - p)));
+
+        p = fineData + 1;
+    }
+
+    return true;
+}
+
+// Controlla che i byte siano UTF-8 valido: sequenze complete,
+// senza forme troppo lunghe, surrogati o valori oltre U+10FFFF
+bool utf8Valido(const QByteArray &dati){
+
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(dati.constData());
+    const unsigned char *fine = p + dati.size();
+
+    while(p < fine){
+        unsigned char c = *p++;
+        if(c < 0x80)
+            continue;
+
+        int seguenti;
+        unsigned minimo;
+        unsigned valore;
+
+        if(c >= 0xC2 && c <= 0xDF){
+            seguenti = 1; minimo = 0x80; valore = c & 0x1F;
+        }else if(c >= 0xE0 && c <= 0xEF){
+            seguenti = 2; minimo = 0x800; valore = c & 0x0F;
+        }else if(c >= 0xF0 && c <= 0xF4){
+            seguenti = 3; minimo = 0x10000; valore = c & 0x07;
+        }else{
+            return false;
+        }
+
+        if(fine - p < seguenti)
+            return false;
+
+        for(int i = 0; i < seguenti; ++i, ++p){
+            if((*p & 0xC0) != 0x80)
+                return false;
+            valore = (valore << 6) | (*p & 0x3F);
+        }
+
+        if(valore < minimo || valore > 0x10FFFF || (valore >= 0xD800 && valore <= 0xDFFF))
+            return false;
+    }
+
+    return true;
+}
+
+QString leggiRigaUtf8(QIODevice &file){
+
+    QByteArray riga = file.readLine();
+
+    if(riga.endsWith('\n'))
+        riga.chop(1);
+    if(riga.endsWith('\r'))
+        riga.chop(1);
+
+    return QString::fromUtf8(riga);
+}
+
+int chiaveMese(const QDate &data){
+    return data.year() * 12 + data.month() - 1;
+}
+
+bool IndiceSnapshot::leggi(const QString &percorso){
+
+    QFile file(percorso);
+
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    QTextStream in(&file);
+
+    QStringList intestazione = in.readLine().split(";");
+    if(intestazione.size() != 2 || intestazione[0] != "#generazione")
+        return false;
+
+    generazione = intestazione[1].toULongLong();
+    mesi.clear();
+
+    while(!in.atEnd()){
+        QStringList parti = in.readLine().split(";");
+        if(parti.size() != 3)
+            return false;
+
+        BloccoFile blocco = {parti[1].toLongLong(), parti[2].toLongLong()};
+
+        if(parti[0] == "regole"){
+            regole = blocco;
+            continue;
+        }
+
+        QStringList mese = parti[0].split("-");
+        if(mese.size() != 2)
+            return false;
+
+        mesi.insert(mese[0].toInt() * 12 + mese[1].toInt() - 1, blocco);
+    }
+
+    return true;
+}
+
+bool IndiceSnapshot::scrivi(const QString &percorso) const{
+
+    QSaveFile file(percorso);
+
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    QTextStream out(&file);
+
+    out << "#generazione;" << generazione << "\n";
+    out << "regole;" << regole.inizio << ";" << regole.lunghezza << "\n";
+
+    for(QMap<int, BloccoFile>::const_iterator it = mesi.constBegin(); it != mesi.constEnd(); ++it){
+        out << QString("%1-%2").arg(it.key() / 12).arg(it.key() % 12 + 1, 2, 10, QChar('0')) << ";"
+            << it.value().inizio << ";" << it.value().lunghezza << "\n";
+    }
+
+    out.flush();
+    return file.commit();
+}
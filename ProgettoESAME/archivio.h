@@ -0,0 +1,57 @@
+#ifndef ARCHIVIO_H
+#define ARCHIVIO_H
+
+#include <QDate>
+#include <QMap>
+#include <QStringList>
+#include <QTextStream>
+#include "task.h"
+#include "ricorrenza.h"
+
+// Formato delle righe di attivita.txt e del journal.
+// Un task è data;tipo;titolo;inizio;fine;frequenza;completato,
+// una regola aggiunge la data di fine e le eccezioni separate da ','.
+
+void scriviTask(QTextStream &out, const QDate &data, const Task &task);
+void scriviRegola(QTextStream &out, const RegolaRicorrenza &regola);
+
+bool leggiTask(const QStringList &parti, int primo, QDate &data, Task &task);
+bool leggiRegola(const QStringList &parti, int primo, RegolaRicorrenza &regola);
+
+// Lettura diretta dai byte UTF-8 di una riga di attivita.txt (senza '\n'),
+// senza QStringList né QDate/QTime::fromString. Falliscono se la riga
+// non ha esattamente 7 campi (task) o 9 campi (regola).
+bool leggiTask(const char *inizio, const char *fine, QDate &data, Task &task);
+bool leggiRegola(const char *inizio, const char *fine, RegolaRicorrenza &regola);
+
+// true se i byte sono UTF-8 valido
+bool utf8Valido(const QByteArray &dati);
+
+// Legge la prossima riga del file decodificandola come UTF-8,
+// senza il '\n' (e l'eventuale '\r') finale
+QString leggiRigaUtf8(QIODevice &file);
+
+// Chiave di un mese per IndiceSnapshot: anno * 12 + (mese - 1)
+int chiaveMese(const QDate &data);
+
+// Righe di attivita.txt nel file: posizione del primo byte e numero di byte
+struct BloccoFile{
+    qint64 inizio;
+    qint64 lunghezza;
+};
+
+// Indice di attivita.txt, salvato accanto allo snapshot. Le righe dei task
+// sono ordinate per data, quindi ogni mese è un blocco contiguo; le regole
+// sono in un blocco a parte alla fine del file.
+// Il formato è una riga #generazione;N seguita da righe
+// "regole;inizio;lunghezza" e "aaaa-mm;inizio;lunghezza".
+struct IndiceSnapshot{
+    quint64 generazione = 0;
+    QMap<int, BloccoFile> mesi;
+    BloccoFile regole = {0, 0};
+
+    bool leggi(const QString &percorso);
+    bool scrivi(const QString &percorso) const;
+};
+
+#endif // ARCHIVIO_H
@@ -0,0 +1,97 @@
+#include "indicesovrapposizioni.h"
+#include <algorithm>
+
+// Fascia oraria di un'attività, come in esisteSovrapposizione:
+// senza ora di fine l'attività dura zero minuti, e le attività
+// che finiscono prima di iniziare vengono ignorate.
+bool IndiceSovrapposizioni::fasciaOraria(const Task &task, int &inizio, int &fine){
+
+    if(task.type() != TaskType::Activity)
+        return false;
+
+    inizio = task.startMinute();
+    fine = task.hasEndTime() ? task.endMinute() : inizio;
+    return fine >= inizio;
+}
+
+void IndiceSovrapposizioni::aggiornaMassimi(Giorno &giorno, int da){
+
+    giorno.maxFine.resize(giorno.fini.size());
+
+    for(int i = da; i < giorno.fini.size(); ++i){
+        int precedente = (i > 0) ? giorno.maxFine[i-1] : giorno.fini[i];
+        giorno.maxFine[i] = std::max(precedente, giorno.fini[i]);
+    }
+}
+
+void IndiceSovrapposizioni::aggiungi(const QDate &data, const Task &task){
+
+    int inizio, fine;
+    if(!fasciaOraria(task, inizio, fine))
+        return;
+
+    Giorno &giorno = giorni[data];
+    int pos = std::upper_bound(giorno.inizi.begin(), giorno.inizi.end(), inizio) - giorno.inizi.begin();
+
+    giorno.inizi.insert(pos, inizio);
+    giorno.fini.insert(pos, fine);
+    aggiornaMassimi(giorno, pos);
+}
+
+void IndiceSovrapposizioni::rimuovi(const QDate &data, const Task &task){
+
+    int inizio, fine;
+    if(!fasciaOraria(task, inizio, fine))
+        return;
+
+    QHash<QDate, Giorno>::iterator it = giorni.find(data);
+    if(it == giorni.end())
+        return;
+
+    Giorno &giorno = it.value();
+    int pos = std::lower_bound(giorno.inizi.begin(), giorno.inizi.end(), inizio) - giorno.inizi.begin();
+
+    // tra gli intervalli con lo stesso inizio cerco quello con la stessa fine
+    while(pos < giorno.inizi.size() && giorno.inizi[pos] == inizio && giorno.fini[pos] != fine)
+        ++pos;
+
+    if(pos == giorno.inizi.size() || giorno.inizi[pos] != inizio)
+        return;
+
+    giorno.inizi.remove(pos);
+    giorno.fini.remove(pos);
+
+    if(giorno.inizi.isEmpty())
+        giorni.erase(it);
+    else
+        aggiornaMassimi(giorno, pos);
+}
+
+bool IndiceSovrapposizioni::esisteSovrapposizione(const QDate &data, const QTime &start, const QTime &end) const{
+
+    QHash<QDate, Giorno>::const_iterator it = giorni.constFind(data);
+    if(it == giorni.constEnd())
+        return false;
+
+    const Giorno &giorno = it.value();
+
+    // gli intervalli che iniziano prima di end sono i primi n,
+    // uno di questi si sovrappone se il più tardivo finisce dopo start
+    int n = std::lower_bound(giorno.inizi.begin(), giorno.inizi.end(), minutiDelGiorno(end)) - giorno.inizi.begin();
+
+    return n > 0 && giorno.maxFine[n-1] > minutiDelGiorno(start);
+}
+
+// Controllo su una singola attività, usato per quelle fuori dall'indice
+bool IndiceSovrapposizioni::siSovrappone(const Task &task, const QTime &start, const QTime &end){
+
+    int inizio, fine;
+    if(!fasciaOraria(task, inizio, fine))
+        return false;
+
+    return inizio < minutiDelGiorno(end) && fine > minutiDelGiorno(start);
+}
+
+void IndiceSovrapposizioni::clear(){
+    giorni.clear();
+}
@@ -0,0 +1,38 @@
+#ifndef INDICESOVRAPPOSIZIONI_H
+#define INDICESOVRAPPOSIZIONI_H
+
+#include <QDate>
+#include <QHash>
+#include <QTime>
+#include <QVector>
+#include "task.h"
+
+// Indice per data delle fasce orarie occupate dalle attività.
+// Per ogni giorno gli intervalli sono ordinati per ora di inizio e
+// maxFine[i] è la massima ora di fine tra i primi i+1 intervalli,
+// così il controllo di sovrapposizione è una ricerca binaria.
+// Gli eventi non occupano fasce orarie e non vengono indicizzati.
+class IndiceSovrapposizioni
+{
+public:
+    void aggiungi(const QDate &data, const Task &task);
+    void rimuovi(const QDate &data, const Task &task);
+    bool esisteSovrapposizione(const QDate &data, const QTime &start, const QTime &end) const;
+    void clear();
+
+    static bool siSovrappone(const Task &task, const QTime &start, const QTime &end);
+
+private:
+    struct Giorno{
+        QVector<int> inizi;   // minuti dall'inizio del giorno, in ordine crescente
+        QVector<int> fini;    // fine dell'intervallo che inizia in inizi[i]
+        QVector<int> maxFine;
+    };
+
+    static bool fasciaOraria(const Task &task, int &inizio, int &fine);
+    static void aggiornaMassimi(Giorno &giorno, int da);
+
+    QHash<QDate, Giorno> giorni;
+};
+
+#endif // INDICESOVRAPPOSIZIONI_H
@@ -0,0 +1,85 @@
+#include "journal.h"
+#include "archivio.h"
+#include <QFile>
+
+Journal::Journal(ScrittoreAsincrono &scrittore, const QString &percorso)
+    : scrittore(scrittore)
+    , percorso(percorso)
+{
+}
+
+// Conta le operazioni del journal esistente e lo fa aprire in coda.
+// Se il file appartiene a un'altra generazione (o non esiste) viene ricreato vuoto.
+void Journal::apri(quint64 generazione){
+
+    QFile file(percorso);
+    bool stessaGenerazione = false;
+
+    numeroOperazioni = 0;
+
+    if(file.open(QIODevice::ReadOnly | QIODevice::Text)){
+        stessaGenerazione = (leggiRigaUtf8(file) == QString("#generazione;%1").arg(generazione));
+
+        while(stessaGenerazione && !file.atEnd()){
+            file.readLine();
+            ++numeroOperazioni;
+        }
+    }
+
+    scrittore.apriJournal(generazione, stessaGenerazione);
+}
+
+// Dopo la richiesta di uno snapshot il journal riparte da zero operazioni
+void Journal::ricomincia(){
+    numeroOperazioni = 0;
+}
+
+int Journal::operazioni() const{
+    return numeroOperazioni;
+}
+
+void Journal::scrivi(const QString &riga){
+    scrittore.accoda(riga);
+    ++numeroOperazioni;
+}
+
+void Journal::aggiungiTask(const QDate &data, const Task &task){
+
+    QString riga;
+    QTextStream out(&riga);
+    out << "A;";
+    scriviTask(out, data, task);
+    out.flush();
+
+    scrivi(riga);
+}
+
+void Journal::aggiornaTask(const QDate &data, int indice, const Task &task){
+
+    QString riga;
+    QTextStream out(&riga);
+    out << "U;" << indice << ";";
+    scriviTask(out, data, task);
+    out.flush();
+
+    scrivi(riga);
+}
+
+void Journal::rimuoviTask(const QDate &data, int indice){
+    scrivi(QString("D;%1;%2").arg(indice).arg(data.toString("yyyy-MM-dd")));
+}
+
+void Journal::aggiungiRegola(const RegolaRicorrenza &regola){
+
+    QString riga;
+    QTextStream out(&riga);
+    out << "R;";
+    scriviRegola(out, regola);
+    out.flush();
+
+    scrivi(riga);
+}
+
+void Journal::aggiungiEccezione(int indiceRegola, const QDate &data){
+    scrivi(QString("E;%1;%2").arg(indiceRegola).arg(data.toString("yyyy-MM-dd")));
+}
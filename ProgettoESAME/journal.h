@@ -0,0 +1,42 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <QString>
+#include "task.h"
+#include "ricorrenza.h"
+#include "scrittoreasincrono.h"
+
+// Journal delle modifiche al calendario, scritto in coda dopo ogni operazione.
+// Ogni riga è un'operazione:
+//   A;<task>                  aggiunge un task singolo
+//   U;<indice>;<task>         sostituisce il task in posizione indice della data
+//   D;<indice>;<data>         cancella il task in posizione indice della data
+//   R;<regola>                aggiunge una regola di ricorrenza
+//   E;<indice>;<data>         aggiunge un'eccezione alla regola in posizione indice
+// La prima riga, #generazione;N, lega il journal allo snapshot con la stessa
+// generazione: un journal di una generazione diversa è già compreso nello snapshot.
+// Le righe vengono scritte dal thread di ScrittoreAsincrono.
+class Journal
+{
+public:
+    Journal(ScrittoreAsincrono &scrittore, const QString &percorso);
+
+    void apri(quint64 generazione);
+    void ricomincia();
+    int operazioni() const;
+
+    void aggiungiTask(const QDate &data, const Task &task);
+    void aggiornaTask(const QDate &data, int indice, const Task &task);
+    void rimuoviTask(const QDate &data, int indice);
+    void aggiungiRegola(const RegolaRicorrenza &regola);
+    void aggiungiEccezione(int indiceRegola, const QDate &data);
+
+private:
+    void scrivi(const QString &riga);
+
+    ScrittoreAsincrono &scrittore;
+    QString percorso;
+    int numeroOperazioni = 0;
+};
+
+#endif // JOURNAL_H
@@ -1,10 +1,39 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEvent>
+
+// Stampa il tempo dall'avvio al primo disegno di un widget.
+// Attivo solo se è impostata la variabile d'ambiente ATTIVITA_TEMPO_AVVIO.
+class TempoPrimoDisegno : public QObject {
+public:
+    TempoPrimoDisegno() {
+        avvio.start();
+    }
+
+    bool eventFilter(QObject *oggetto, QEvent *evento) override {
+        if(evento->type() == QEvent::Paint){
+            qDebug() << "Primo disegno dopo" << avvio.elapsed() << "ms";
+            qApp->removeEventFilter(this);
+        }
+        return QObject::eventFilter(oggetto, evento);
+    }
+
+private:
+    QElapsedTimer avvio;
+};
 
 int main(int argc, char *argv[])
 {
+    TempoPrimoDisegno tempo;
+    bool misuraAvvio = qEnvironmentVariableIsSet("ATTIVITA_TEMPO_AVVIO");
+
     QApplication a(argc, argv);
+    if(misuraAvvio)
+        a.installEventFilter(&tempo);
+
     MainWindow w;
     w.show();
     return a.exec();
@@ -3,13 +3,21 @@
 #include <QDebug>
 #include <QMessageBox>
 #include <QFile>
-#include <QFileInfo>
+#include <cstring>
+#include "archivio.h"
+
+// operazioni nel journal oltre le quali attivita.txt viene riscritto
+static const int MAX_OPERAZIONI_JOURNAL = 1000;
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , modello(new TaskTableModel(this))
+    , scrittore("attivita.txt", "attivita.journal", "attivita.indice")
+    , journal(scrittore, "attivita.journal")
 {
     ui->setupUi(this);
+    ui->tableActivities->setModel(modello);
 
     caricaDaFile();
 
@@ -23,9 +31,9 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onUpdateTaskClicked);
     connect(ui->btnDeleteTask, &QPushButton::clicked,
             this, &MainWindow::onDeleteTaskClicked);
-    connect(ui->tableActivities, &QTableWidget::itemSelectionChanged,
+    connect(ui->tableActivities->selectionModel(), &QItemSelectionModel::selectionChanged,
             this, &MainWindow::onTableSelectionChanged);
-    connect(ui->tableActivities, &QTableWidget::itemClicked,
+    connect(ui->tableActivities, &QTableView::clicked,
             this, &MainWindow::onTableItemClicked);
 
 
@@ -36,7 +44,11 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
-    salvaSuFile();
+    // l'ultimo salvataggio deve essere su disco prima di uscire;
+    // se è stato letto solo qualche mese e non è cambiato nulla, il file è già aggiornato
+    if(journal.operazioni() > 0 || !caricamentoParziale)
+        salvaSuFile();
+    scrittore.attendi();
     delete ui;
 }
 
@@ -45,45 +57,33 @@ void MainWindow::onDateClicked(const QDate &date){
     refreshTable(selectedDate);
 }
 
+// Ricarica il modello con le voci di una data, usato solo al cambio di giorno:
+// inserimenti, modifiche e cancellazioni aggiornano solo le righe interessate
 void MainWindow::refreshTable(const QDate &date){
+    assicuraCaricato(date);
+    index_task_da_editare = -1;
+    modello->impostaVoci(vociDelGiorno(date));
+}
 
-    ui->tableActivities->setRowCount(0);
-    QList<Task> tasksOfDay = tasksByDate.value(date);
+// task singoli della data più le istanze delle regole che cadono in quella data
+QList<VoceGiorno> MainWindow::vociDelGiorno(const QDate &date){
 
-    // ordinamento per ora di inizio attività
-    for(int i = 0; i < tasksOfDay.size()-1; ++i){
-        for(int j = i+1; j < tasksOfDay.size(); ++j){
+    QList<VoceGiorno> voci;
 
-            if(tasksOfDay[j].startTime < tasksOfDay[i].startTime){
-                Task temp = tasksOfDay[i];
-                tasksOfDay[i] = tasksOfDay[j];
-                tasksOfDay[j] = temp;
-            }
-        }
+    QMap<QDate, QList<Task>>::const_iterator it = tasksByDate.constFind(date);
+    if(it != tasksByDate.constEnd()){
+        for(int i = 0; i < it.value().size(); ++i)
+            voci.append(VoceGiorno{it.value()[i], i, -1});
     }
 
-    for(int i = 0; i < tasksOfDay.size(); ++i){
-        int row = ui->tableActivities->rowCount();
-        ui->tableActivities->insertRow(row);
-
-        QString typeText;
-        if(tasksOfDay[i].type == TaskType::Event){
-            typeText = "Evento";
-        }else{
-            typeText = "Attività";
-        }
-        ui->tableActivities->setItem(row, 0, new QTableWidgetItem(typeText));
-        ui->tableActivities->setItem(row, 1, new QTableWidgetItem(tasksOfDay[i].title));
-        ui->tableActivities->setItem(row, 2, new QTableWidgetItem(tasksOfDay[i].startTime.toString("HH:mm")));
-        if(tasksOfDay[i].hasEndTime){
-             ui->tableActivities->setItem(row, 3, new QTableWidgetItem(tasksOfDay[i].endTime.toString("HH:mm")));
-        } else {
-             ui->tableActivities->setItem(row, 3, new QTableWidgetItem("-"));
-        }
-        ui->tableActivities->setItem(row, 4, new QTableWidgetItem(tasksOfDay[i].frequency));
-
+    const QVector<int> &delGiorno = istanzeRegole.regoleDelGiorno(regole, date);
+    for(int i = 0; i < delGiorno.size(); ++i){
+        int r = delGiorno[i];
+        if(regole[r].ricorreIl(date))
+            voci.append(VoceGiorno{regole[r].base, -1, r});
     }
 
+    return voci;
 }
 
 void MainWindow::onSaveTaskClicked(){
@@ -100,12 +100,12 @@ void MainWindow::onSaveTaskClicked(){
     Task task;
 
     if(ui->comboType->currentText()=="Evento"){
-        task.type = TaskType::Event;
+        task.setType(TaskType::Event);
     }else{
-        task.type = TaskType::Activity;
+        task.setType(TaskType::Activity);
     }
 
-    if(task.type == TaskType::Activity){
+    if(task.type() == TaskType::Activity){
         if(ui->checkEndTime->isChecked() && (oraFine < oraInizio)){
             QMessageBox::warning(this, "Orario non valido","L'orario di fine deve essere successivo all'orario di inizio.");
             return;
@@ -117,24 +117,32 @@ void MainWindow::onSaveTaskClicked(){
         }
     }
 
-    task.title = ui->editTitle->text();
-    task.startTime = ui->timeStart->time();
+    task.title = Titolo(ui->editTitle->text());
+    task.setStartTime(ui->timeStart->time());
 
-    task.hasEndTime = ui->checkEndTime->isChecked();
-    if(task.hasEndTime){
-        task.endTime = ui->timeEnd->time();
+    task.setHasEndTime(ui->checkEndTime->isChecked());
+    if(task.hasEndTime()){
+        task.setEndTime(ui->timeEnd->time());
     }
 
-    task.frequency = ui->comboFrequency->currentText();
-    task.completed = false;
+    task.setFrequency(frequenzaDaTesto(ui->comboFrequency->currentText()));
+    task.setCompleted(false);
 
-    tasksByDate[selectedDate].append(task);
-    if(task.frequency != "Nessuna"){
+    if(task.frequency() != Frequency::None){
         generaRicorrenze(task, selectedDate);
+        int indiceRegola = regole.size() - 1;
+        modello->inserisci(VoceGiorno{task, -1, indiceRegola});
+        journal.aggiungiRegola(regole.last());
+    }else{
+        QList<Task> &tasksOfDay = tasksByDate[selectedDate];
+        tasksOfDay.append(task);
+        indiceAttivita.aggiungi(selectedDate, task);
+        int indiceTask = tasksOfDay.size() - 1;
+        modello->inserisci(VoceGiorno{task, indiceTask, -1});
+        journal.aggiungiTask(selectedDate, task);
     }
 
-    salvaSuFile();
-    refreshTable(selectedDate);
+    registraModifica();
 
 }
 
@@ -143,113 +151,126 @@ void MainWindow::onUpdateTaskClicked(){
     if(index_task_da_editare < 0)
         return;
 
-    QList<Task> &tasksOfDay = tasksByDate[selectedDate];
-
-    if(index_task_da_editare >= tasksOfDay.size())
+    if(index_task_da_editare >= modello->rowCount())
         return;
 
-    Task &task = tasksOfDay[index_task_da_editare];
+    const VoceGiorno voce = modello->voce(index_task_da_editare);
+    Task task = voce.task;
 
     if(ui->comboType->currentText()=="Evento"){
-        task.type = TaskType::Event;
+        task.setType(TaskType::Event);
     }else{
-        task.type = TaskType::Activity;
+        task.setType(TaskType::Activity);
     }
 
-    task.title = ui->editTitle->text();
-    task.startTime = ui->timeStart->time();
+    task.title = Titolo(ui->editTitle->text());
+    task.setStartTime(ui->timeStart->time());
 
-    task.hasEndTime = ui->checkEndTime->isChecked();
-    if(task.hasEndTime){
-        task.endTime = ui->timeEnd->time();
+    task.setHasEndTime(ui->checkEndTime->isChecked());
+    if(task.hasEndTime()){
+        task.setEndTime(ui->timeEnd->time());
     }
 
-    task.frequency = ui->comboFrequency->currentText();
+    task.setFrequency(frequenzaDaTesto(ui->comboFrequency->currentText()));
 
-    index_task_da_editare = -1;
+    VoceGiorno aggiornata{task, voce.indiceTask, -1};
 
-    salvaSuFile();
+    if(voce.indiceRegola >= 0){
+        // l'istanza modificata diventa un task singolo e la regola salta questa data
+        regole[voce.indiceRegola].eccezioni.insert(selectedDate);
+        QList<Task> &tasksOfDay = tasksByDate[selectedDate];
+        tasksOfDay.append(task);
+        aggiornata.indiceTask = tasksOfDay.size() - 1;
+        journal.aggiungiEccezione(voce.indiceRegola, selectedDate);
+        journal.aggiungiTask(selectedDate, task);
+    }else{
+        Task &originale = tasksByDate[selectedDate][voce.indiceTask];
+        indiceAttivita.rimuovi(selectedDate, originale);
+        originale = task;
+        journal.aggiornaTask(selectedDate, voce.indiceTask, task);
+    }
+    indiceAttivita.aggiungi(selectedDate, task);
 
-    refreshTable(selectedDate);
+    modello->aggiorna(index_task_da_editare, aggiornata);
+    index_task_da_editare = -1;
+
+    registraModifica();
 
 }
 
 void MainWindow::onTableSelectionChanged(){
 
-    bool selection = !ui->tableActivities->selectedItems().isEmpty();
+    bool selection = ui->tableActivities->selectionModel()->hasSelection();
     ui->btnDeleteTask->setEnabled(selection);
     ui->btnUpdateTask->setEnabled(selection);
 }
 
 void MainWindow::onDeleteTaskClicked(){
 
-    int row = ui->tableActivities->currentRow();
+    int row = ui->tableActivities->currentIndex().row();
 
     // Nessuna riga selezionata
     if(row < 0)
         return;
 
-    // recupero la lista di attività del giorno
-    QList<Task> &tasksOfDay = tasksByDate[selectedDate];
-
     // controllo di sicurezza
-    if(row >= tasksOfDay.size())
+    if(row >= modello->rowCount())
         return;
 
-    // rimuovo l'attività
-    tasksOfDay.removeAt(row);
+    const VoceGiorno voce = modello->voce(row);
+
+    if(voce.indiceRegola >= 0){
+        // cancello solo questa istanza della ricorrenza
+        regole[voce.indiceRegola].eccezioni.insert(selectedDate);
+        journal.aggiungiEccezione(voce.indiceRegola, selectedDate);
+    }else{
+        // rimuovo l'attività
+        QList<Task> &tasksOfDay = tasksByDate[selectedDate];
+        indiceAttivita.rimuovi(selectedDate, tasksOfDay[voce.indiceTask]);
+        tasksOfDay.removeAt(voce.indiceTask);
+        journal.rimuoviTask(selectedDate, voce.indiceTask);
+    }
 
-    salvaSuFile();
+    modello->rimuovi(row);
+    index_task_da_editare = -1;
 
-    refreshTable(selectedDate);
+    registraModifica();
 }
 
-void MainWindow::onTableItemClicked(QTableWidgetItem *item){
+void MainWindow::onTableItemClicked(const QModelIndex &index){
 
-    int row = item->row();
-    QList<Task> &tasksOfDay = tasksByDate[selectedDate];
+    int row = index.row();
 
-    if(row < 0 || row >= tasksOfDay.size())
+    if(row < 0 || row >= modello->rowCount())
         return;
 
-    const Task &task = tasksOfDay[row];
+    const Task &task = modello->voce(row).task;
     index_task_da_editare = row;
 
-    ui->comboType->setCurrentText(task.type == TaskType::Event ? "Evento" : "Attività");
-    ui->editTitle->setText(task.title);
-    ui->timeStart->setTime(task.startTime);
-    ui->checkEndTime->setChecked(task.hasEndTime);
-    ui->timeEnd->setEnabled(task.hasEndTime);
-    if(task.hasEndTime)
-        ui->timeEnd->setTime(task.endTime);
+    ui->comboType->setCurrentText(task.type() == TaskType::Event ? "Evento" : "Attività");
+    ui->editTitle->setText(task.title.testo());
+    ui->timeStart->setTime(task.startTime());
+    ui->checkEndTime->setChecked(task.hasEndTime());
+    ui->timeEnd->setEnabled(task.hasEndTime());
+    if(task.hasEndTime())
+        ui->timeEnd->setTime(task.endTime());
 
-    ui->comboFrequency->setCurrentText(task.frequency);
+    ui->comboFrequency->setCurrentText(testoFrequenza(task.frequency()));
 }
 
 bool MainWindow::esisteSovrapposizione(const QDate &date, const QTime &start, const QTime &end){
 
-    const QList<Task> &tasksOfDay = tasksByDate.value(date);
-
-    for(int i = 0; i < tasksOfDay.size(); ++i){
-
-        QTime otherStart = tasksOfDay[i].startTime;
-        QTime otherEnd;
-
-        if(tasksOfDay[i].type == TaskType::Event)
-            continue;
+    assicuraCaricato(date);
 
-        if(tasksOfDay[i].hasEndTime){
-            otherEnd = tasksOfDay[i].endTime;
-        }else{
-            otherEnd = tasksOfDay[i].startTime;
-        }
-
-        if(otherEnd >= otherStart){
-            if((start < otherEnd) && (end > otherStart)){
-                return true;
-            }
-        }
+    if(indiceAttivita.esisteSovrapposizione(date, start, end))
+        return true;
 
+    // le istanze delle ricorrenze non sono nell'indice delle attività
+    const QVector<int> &delGiorno = istanzeRegole.regoleDelGiorno(regole, date);
+    for(int i = 0; i < delGiorno.size(); ++i){
+        const RegolaRicorrenza &regola = regole[delGiorno[i]];
+        if(regola.ricorreIl(date) && IndiceSovrapposizioni::siSovrappone(regola.base, start, end))
+            return true;
     }
 
     return false;
@@ -257,123 +278,197 @@ bool MainWindow::esisteSovrapposizione(const QDate &date, const QTime &start, co
 
 void MainWindow::generaRicorrenze(const Task &taskBase, const QDate &dataDiInizio){
 
-    QDate fineAnno = QDate(dataDiInizio.year(), 12, 31);
+    RegolaRicorrenza regola;
+    regola.base = taskBase;
+    regola.inizio = dataDiInizio;
+    regola.fine = QDate(dataDiInizio.year(), 12, 31);
 
-    QDate current = dataDiInizio;
+    // le istanze che si sovrappongono a un'altra attività vengono saltate
+    if(taskBase.type() == TaskType::Activity){
+        QTime orarioDiFine = taskBase.hasEndTime() ? taskBase.endTime() : taskBase.startTime();
 
-    if(taskBase.frequency == "Giornaliera"){
-        current = current.addDays(1);
-        while (current <= fineAnno) {
-            aggiungiIstanza(taskBase, current);
-            current = current.addDays(1);
+        for(int k = 1; regola.occorrenza(k).isValid() && regola.occorrenza(k) <= regola.fine; ++k){
+            QDate data = regola.occorrenza(k);
+            if(esisteSovrapposizione(data, taskBase.startTime(), orarioDiFine))
+                regola.eccezioni.insert(data);
         }
     }
 
-    else if(taskBase.frequency == "Settimanale"){
-        current = current.addDays(7);
-        while(current <= fineAnno){
-            aggiungiIstanza(taskBase, current);
-            current = current.addDays(7);
-        }
-    }
-
-    else if(taskBase.frequency == "Mensile"){
-        current = current.addMonths(1);
-        while(current <= fineAnno){
-            aggiungiIstanza(taskBase, current);
-            current = current.addMonths(1);
-        }
-    }
+    aggiungiRegola(regola);
 }
 
-void MainWindow::aggiungiIstanza(const Task &base, const QDate &data){
-
-    if(base.type == TaskType::Activity){
-        QTime orarioDiFine = base.hasEndTime ? base.endTime : base.startTime;
+void MainWindow::aggiungiRegola(const RegolaRicorrenza &regola){
+    regole.append(regola);
+    istanzeRegole.aggiungiRegola(regole, regole.size() - 1);
+}
 
-        if(esisteSovrapposizione(data, base.startTime, orarioDiFine))
-            return;
-    }
+// attività su file
 
-    Task t = base;
-    t.frequency = base.frequency;
-    tasksByDate[data].append(t);
+// Ogni modifica è già nel journal: attivita.txt viene riscritto
+// solo quando il journal diventa troppo lungo
+void MainWindow::registraModifica(){
 
+    if(journal.operazioni() >= MAX_OPERAZIONI_JOURNAL)
+        salvaSuFile();
 }
 
-// attività su file
-
+// Accoda lo snapshot completo della generazione successiva: il thread di
+// scrittura lo salva e poi ricomincia il journal.
+// tasksByDate e regole vengono condivisi senza copia fino alla prossima modifica
 void MainWindow::salvaSuFile(){
 
-    QFile file("attivita.txt");
+    ++generazione;
+    scrittore.salva(tasksByDate, regole, mesiCaricati, !caricamentoParziale, generazione);
+    journal.ricomincia();
+}
 
-    // apro file in scrittura, se non esiste lo crea
-    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
-        return;
+// Se attivita.indice è della stessa generazione di attivita.txt vengono lette
+// solo le regole e i mesi intorno ad oggi; gli altri mesi vengono letti
+// da assicuraCaricato quando servono. Altrimenti il file è letto per intero.
+void MainWindow::caricaDaFile(){
 
-    QTextStream out(&file);
+    QFile file("attivita.txt");
 
-    QList<QDate> date = tasksByDate.keys();
+    if(file.open(QIODevice::ReadOnly)){
 
-    for(int i = 0; i < date.size(); ++i){
+        // intestazione degli snapshot scritti insieme al journal
+        QByteArray prima = file.readLine();
+        bool conIntestazione = prima.startsWith("#generazione;");
+        if(conIntestazione)
+            generazione = prima.mid(13).trimmed().toULongLong();
 
-        QList<Task> lista = tasksByDate[date[i]];
+        if(generazione > 0 && scrittore.apriIndice(generazione)){
+            caricamentoParziale = true;
+            caricaRighe(scrittore.leggiRegole());
 
-        for(int j = 0; j < lista.size(); ++j){
+            QDate oggi = QDate::currentDate();
+            for(int mese = -1; mese <= 1; ++mese)
+                assicuraCaricato(oggi.addMonths(mese));
+        }else{
+            QByteArray righe = file.readAll();
 
-            out << date[i].toString("yyyy-MM-dd") << ";"
-                << (lista[j].type == TaskType::Event ? "Evento" : "Attività") << ";"
-                << lista[j].title << ";"
-                << lista[j].startTime.toString("HH:mm") << ";";
+            if(!conIntestazione){
+                righe.prepend(prima);
 
-            if(lista[j].hasEndTime)
-                out << lista[j].endTime.toString("HH:mm");
-            else
-                out << "";
+                // le versioni precedenti scrivevano il file con la codifica locale
+                if(!utf8Valido(righe))
+                    righe = QString::fromLocal8Bit(righe).toUtf8();
+            }
 
-            out << ";" <<lista[j].frequency << ";"
-                << (lista[j].completed ? "1":"0") <<"\n";
+            caricaRighe(righe);
         }
+
+        file.close();
     }
 
-    file.close();
-    qDebug() << "File salvato in: " << QFileInfo(file).absoluteFilePath();
+    riproduciJournal();
+    journal.apri(generazione);
 }
 
-void MainWindow::caricaDaFile(){
+void MainWindow::caricaRiga(const char *inizio, const char *fine){
 
-    QFile file("attivita.txt");
+    QDate data;
+    Task t;
 
-    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    if(leggiTask(inizio, fine, data, t)){
+        tasksByDate[data].append(t);
+        indiceAttivita.aggiungi(data, t);
         return;
+    }
 
-    QTextStream in(&file);
+    // le righe con data di fine ed eccezioni sono regole di ricorrenza
+    RegolaRicorrenza regola;
+    if(leggiRegola(inizio, fine, regola))
+        aggiungiRegola(regola);
+}
 
-    while(!in.atEnd()){
-        QString riga = in.readLine();
-        QStringList parti = riga.split(";");
+// Righe di attivita.txt in UTF-8, analizzate direttamente sui byte
+void MainWindow::caricaRighe(const QByteArray &righe){
 
-        QDate data = QDate::fromString(parti[0], "yyyy-MM-dd");
+    const char *p = righe.constData();
+    const char *fine = p + righe.size();
 
-        Task t;
-        t.completed = false;
-
-        t.type = (parti[1] == "Evento") ? TaskType::Event : TaskType::Activity;
-        t.title = parti[2];
-        t.startTime = QTime::fromString(parti[3], "HH:mm");
-        if(!parti[4].isEmpty()){
-            t.endTime = QTime::fromString(parti[4], "HH:mm");
-            t.hasEndTime = true;
-        }else{
-            t.hasEndTime = false;
-        }
+    while(p < fine){
+        const char *aCapo = static_cast<const char*>(memchr(p, '\n', fine - p));
+        const char *fineRiga = aCapo ? aCapo : fine;
 
-        t.frequency = parti[5];
-        t.completed = (parti[6] == "1");
+        // le righe scritte in modalità testo su Windows finiscono con "\r\n"
+        caricaRiga(p, (fineRiga > p && fineRiga[-1] == '\r') ? fineRiga - 1 : fineRiga);
 
-        tasksByDate[data].append(t);
+        p = fineRiga + 1;
     }
+}
+
+// Legge dallo snapshot il mese di date, se non è già in tasksByDate
+void MainWindow::assicuraCaricato(const QDate &date){
+
+    if(!caricamentoParziale)
+        return;
+
+    int chiave = chiaveMese(date);
+    if(mesiCaricati.contains(chiave))
+        return;
 
-    file.close();
+    mesiCaricati.insert(chiave);
+    caricaRighe(scrittore.leggiMese(chiave));
 }
 
+// Applica allo snapshot appena caricato le operazioni del journal
+void MainWindow::riproduciJournal(){
+
+    QFile file("attivita.journal");
+
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+
+    // il journal è scritto in UTF-8, qualunque sia la codifica locale:
+    // le righe sono decodificate da leggiRigaUtf8 e non da un QTextStream.
+    // Un journal di un'altra generazione è già compreso nello snapshot
+    if(leggiRigaUtf8(file) != QString("#generazione;%1").arg(generazione))
+        return;
+
+    while(!file.atEnd()){
+        QStringList parti = leggiRigaUtf8(file).split(";");
+        const QString &operazione = parti[0];
+
+        QDate data;
+        Task t;
+
+        // gli indici di U e D si riferiscono al mese completo
+        if(operazione == "A" && leggiTask(parti, 1, data, t)){
+            assicuraCaricato(data);
+            tasksByDate[data].append(t);
+            indiceAttivita.aggiungi(data, t);
+        }
+        else if(operazione == "U" && leggiTask(parti, 2, data, t)){
+            assicuraCaricato(data);
+            QMap<QDate, QList<Task>>::iterator it = tasksByDate.find(data);
+            int i = parti[1].toInt();
+            if(it != tasksByDate.end() && i >= 0 && i < it.value().size()){
+                indiceAttivita.rimuovi(data, it.value()[i]);
+                it.value()[i] = t;
+                indiceAttivita.aggiungi(data, t);
+            }
+        }
+        else if(operazione == "D" && parti.size() >= 3){
+            data = QDate::fromString(parti[2], "yyyy-MM-dd");
+            assicuraCaricato(data);
+            QMap<QDate, QList<Task>>::iterator it = tasksByDate.find(data);
+            int i = parti[1].toInt();
+            if(it != tasksByDate.end() && i >= 0 && i < it.value().size()){
+                indiceAttivita.rimuovi(data, it.value()[i]);
+                it.value().removeAt(i);
+            }
+        }
+        else if(operazione == "R"){
+            RegolaRicorrenza regola;
+            if(leggiRegola(parti, 1, regola))
+                aggiungiRegola(regola);
+        }
+        else if(operazione == "E" && parti.size() >= 3){
+            int r = parti[1].toInt();
+            if(r >= 0 && r < regole.size())
+                regole[r].eccezioni.insert(QDate::fromString(parti[2], "yyyy-MM-dd"));
+        }
+    }
+}
@@ -4,27 +4,18 @@
 #include <QMainWindow>
 #include <QDate>
 #include <QMap>
-#include <QTableWidget>
+#include <QSet>
+#include <QModelIndex>
+#include "task.h"
+#include "indicesovrapposizioni.h"
+#include "ricorrenza.h"
+#include "tasktablemodel.h"
+#include "journal.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
-enum class TaskType{
-    Event,
-    Activity
-};
-
-struct Task{
-   TaskType type;
-   QString title;
-   QTime startTime;
-   QTime endTime;
-   bool hasEndTime;
-   QString frequency;
-   bool completed;
-};
-
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -38,6 +29,15 @@ private:
 
     QDate selectedDate;
     QMap<QDate, QList<Task>> tasksByDate;
+    IndiceSovrapposizioni indiceAttivita; // fasce orarie delle attività di tasksByDate
+    QList<RegolaRicorrenza> regole;
+    IstanzeRicorrenze istanzeRegole; // regole di ogni giorno, per non scorrere tutte le regole
+    TaskTableModel *modello; // righe mostrate in tabella per selectedDate
+    ScrittoreAsincrono scrittore; // scrive attivita.txt e il journal in un thread dedicato
+    Journal journal;         // modifiche successive all'ultimo salvataggio di attivita.txt
+    quint64 generazione = 0; // generazione dell'ultimo salvataggio
+    bool caricamentoParziale = false; // tasksByDate contiene solo i mesi in mesiCaricati
+    QSet<int> mesiCaricati;           // chiavi di chiaveMese
 
     int index_task_da_editare = -1;
 
@@ -47,15 +47,21 @@ private slots:
     void onUpdateTaskClicked();
     void onDeleteTaskClicked();
     void onTableSelectionChanged();
-    void onTableItemClicked(QTableWidgetItem *item);
+    void onTableItemClicked(const QModelIndex &index);
 
 private:
     void refreshTable(const QDate &date);
     bool esisteSovrapposizione(const QDate &date, const QTime &start, const QTime &end);
     void salvaSuFile();
     void caricaDaFile();
+    void caricaRiga(const char *inizio, const char *fine);
+    void caricaRighe(const QByteArray &righe);
+    void assicuraCaricato(const QDate &date);
+    void riproduciJournal();
+    void registraModifica();
     void generaRicorrenze(const Task &taskBase, const QDate &dataDiInizio);
-    void aggiungiIstanza(const Task &base, const QDate &data);
+    void aggiungiRegola(const RegolaRicorrenza &regola);
+    QList<VoceGiorno> vociDelGiorno(const QDate &date);
 
 
 
@@ -0,0 +1,96 @@
+#include "ricorrenza.h"
+
+// k-esima istanza della regola, la prima (k = 0) è inizio.
+// Le ricorrenze mensili partono sempre da inizio, così un'attività
+// del 31 cade il 28 febbraio e torna il 31 marzo.
+QDate RegolaRicorrenza::occorrenza(int k) const{
+
+    switch(base.frequency()){
+    case Frequency::Daily:
+        return inizio.addDays(k);
+    case Frequency::Weekly:
+        return inizio.addDays(7 * qint64(k));
+    case Frequency::Monthly:
+        return inizio.addMonths(k);
+    default:
+        return (k == 0) ? inizio : QDate();
+    }
+}
+
+static int chiave(const QDate &data){
+    return data.year() * 12 + data.month() - 1;
+}
+
+const QVector<int> &IstanzeRicorrenze::regoleDelGiorno(const QList<RegolaRicorrenza> &regole, const QDate &data){
+
+    static const QVector<int> nessuna;
+
+    if(!mesi.contains(chiave(data))){
+        mesi.insert(chiave(data));
+        QDate primo(data.year(), data.month(), 1);
+        for(int r = 0; r < regole.size(); ++r)
+            aggiungiIstanze(regole[r], r, primo);
+    }
+
+    QHash<QDate, QVector<int>>::const_iterator it = giorni.constFind(data);
+    return it == giorni.constEnd() ? nessuna : it.value();
+}
+
+void IstanzeRicorrenze::aggiungiRegola(const QList<RegolaRicorrenza> &regole, int indice){
+
+    for(QSet<int>::const_iterator it = mesi.constBegin(); it != mesi.constEnd(); ++it)
+        aggiungiIstanze(regole[indice], indice, QDate(*it / 12, *it % 12 + 1, 1));
+}
+
+// Aggiunge le date del mese in cui cade la regola, comprese quelle saltate
+void IstanzeRicorrenze::aggiungiIstanze(const RegolaRicorrenza &regola, int indice, const QDate &primoDelMese){
+
+    QDate ultimo = primoDelMese.addMonths(1).addDays(-1);
+    QDate da = qMax(primoDelMese, regola.inizio);
+    QDate a = (regola.fine.isValid() && regola.fine < ultimo) ? regola.fine : ultimo;
+
+    if(da > a)
+        return;
+
+    switch(regola.base.frequency()){
+    case Frequency::Daily:
+        for(QDate d = da; d <= a; d = d.addDays(1))
+            giorni[d].append(indice);
+        break;
+    case Frequency::Weekly: {
+        qint64 resto = regola.inizio.daysTo(da) % 7;
+        for(QDate d = da.addDays(resto ? 7 - resto : 0); d <= a; d = d.addDays(7))
+            giorni[d].append(indice);
+        break;
+    }
+    case Frequency::Monthly: {
+        QDate d = regola.occorrenza((primoDelMese.year() - regola.inizio.year()) * 12
+                                    + primoDelMese.month() - regola.inizio.month());
+        if(d.isValid() && d >= da && d <= a)
+            giorni[d].append(indice);
+        break;
+    }
+    default:
+        if(regola.inizio >= da && regola.inizio <= a)
+            giorni[regola.inizio].append(indice);
+    }
+}
+
+bool RegolaRicorrenza::ricorreIl(const QDate &data) const{
+
+    if(data < inizio || (fine.isValid() && data > fine) || eccezioni.contains(data))
+        return false;
+
+    qint64 giorni = inizio.daysTo(data);
+
+    switch(base.frequency()){
+    case Frequency::Daily:
+        return true;
+    case Frequency::Weekly:
+        return giorni % 7 == 0;
+    case Frequency::Monthly:
+        return occorrenza((data.year() - inizio.year()) * 12 + data.month() - inizio.month()) == data;
+    default:
+        return giorni == 0;
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef RICORRENZA_H
+#define RICORRENZA_H
+
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QVector>
+#include "task.h"
+
+// Attività o evento che si ripete con la frequenza di base.frequency()
+// (giornaliera, settimanale o mensile) a partire da inizio.
+// Le istanze non vengono memorizzate: si calcolano solo per le date
+// richieste con ricorreIl().
+struct RegolaRicorrenza{
+    Task base;
+    QDate inizio;
+    QDate fine;             // ultima data possibile, non valida se la ricorrenza non ha fine
+    QSet<QDate> eccezioni;  // date in cui l'istanza è stata saltata, modificata o cancellata
+
+    QDate occorrenza(int k) const;
+    bool ricorreIl(const QDate &data) const;
+};
+
+// Indice per giorno delle regole che ricorrono in quel giorno.
+// Le istanze di un mese vengono calcolate la prima volta che il mese
+// serve, scorrendo le regole una sola volta; dopo, un giorno costa solo
+// le regole che vi cadono. Le eccezioni non sono nell'indice: chi lo usa
+// controlla ricorreIl() sulle regole restituite.
+class IstanzeRicorrenze
+{
+public:
+    // indici in regole delle regole che possono ricorrere in data, in ordine crescente
+    const QVector<int> &regoleDelGiorno(const QList<RegolaRicorrenza> &regole, const QDate &data);
+
+    // da chiamare dopo aver aggiunto regole[indice]
+    void aggiungiRegola(const QList<RegolaRicorrenza> &regole, int indice);
+
+private:
+    void aggiungiIstanze(const RegolaRicorrenza &regola, int indice, const QDate &primoDelMese);
+
+    QSet<int> mesi; // anno * 12 + (mese - 1) dei mesi già calcolati
+    QHash<QDate, QVector<int>> giorni;
+};
+
+#endif // RICORRENZA_H
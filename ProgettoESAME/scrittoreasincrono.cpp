@@ -0,0 +1,330 @@
+#include "scrittoreasincrono.h"
+#include "archivio.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+ScrittoreAsincrono::ScrittoreAsincrono(const QString &percorsoSnapshot, const QString &percorsoJournal, const QString &percorsoIndice)
+    : percorsoSnapshot(percorsoSnapshot)
+    , percorsoIndice(percorsoIndice)
+    , journal(percorsoJournal)
+    , snapshot(percorsoSnapshot)
+{
+    thread = std::thread(&ScrittoreAsincrono::esegui, this);
+}
+
+// Scrive tutti i comandi ancora in coda prima di terminare il thread
+ScrittoreAsincrono::~ScrittoreAsincrono(){
+
+    {
+        std::lock_guard<std::mutex> lock(m);
+        chiusura = true;
+    }
+    nuoviComandi.notify_one();
+    thread.join();
+}
+
+// Apre il journal della generazione indicata, in coda a quello esistente
+// oppure ricominciandolo con l'intestazione
+void ScrittoreAsincrono::apriJournal(quint64 generazione, bool inCoda){
+
+    Comando comando;
+    comando.tipo = Comando::ApriJournal;
+    comando.generazione = generazione;
+    comando.inCoda = inCoda;
+
+    {
+        std::lock_guard<std::mutex> lock(m);
+        comandi.append(comando);
+    }
+    nuoviComandi.notify_one();
+}
+
+void ScrittoreAsincrono::accoda(const QString &riga){
+
+    Comando comando;
+    comando.tipo = Comando::Riga;
+    comando.riga = riga;
+
+    {
+        std::lock_guard<std::mutex> lock(m);
+        comandi.append(comando);
+    }
+    nuoviComandi.notify_one();
+}
+
+// Accoda uno snapshot completo. Gli snapshot precedenti non ancora scritti
+// vengono scartati, perché questo contiene anche le loro modifiche; le righe
+// del journal restano, così non si perdono se il salvataggio fallisce.
+// Se tuttoCaricato è falso, i mesi fuori da mesiCaricati non sono in tasks
+// e vengono copiati così come sono dallo snapshot precedente.
+void ScrittoreAsincrono::salva(const QMap<QDate, QList<Task>> &tasks, const QList<RegolaRicorrenza> &regole,
+                               const QSet<int> &mesiCaricati, bool tuttoCaricato, quint64 generazione){
+
+    Comando comando;
+    comando.tipo = Comando::Snapshot;
+    comando.tasks = tasks;
+    comando.regole = regole;
+    comando.mesiCaricati = mesiCaricati;
+    comando.tuttoCaricato = tuttoCaricato;
+    comando.generazione = generazione;
+
+    {
+        std::lock_guard<std::mutex> lock(m);
+        for(int i = comandi.size() - 1; i >= 0; --i){
+            if(comandi[i].tipo == Comando::Snapshot)
+                comandi.removeAt(i);
+        }
+        comandi.append(comando);
+    }
+    nuoviComandi.notify_one();
+}
+
+// Attende che tutti i comandi accodati siano stati scritti
+void ScrittoreAsincrono::attendi(){
+
+    std::unique_lock<std::mutex> lock(m);
+    codaVuota.wait(lock, [this]{ return comandi.isEmpty() && !occupato; });
+}
+
+// Apre lo snapshot per le letture per mese, se il suo indice
+// è aggiornato alla generazione indicata
+bool ScrittoreAsincrono::apriIndice(quint64 generazione){
+
+    std::lock_guard<std::mutex> lock(mFile);
+
+    if(!indice.leggi(percorsoIndice) || indice.generazione != generazione){
+        indice = IndiceSnapshot();
+        return false;
+    }
+
+    snapshot.close();
+    return snapshot.open(QIODevice::ReadOnly);
+}
+
+// Righe dei task del mese indicato (vedi chiaveMese), vuoto se non ce ne sono
+QByteArray ScrittoreAsincrono::leggiMese(int chiave){
+
+    std::lock_guard<std::mutex> lock(mFile);
+
+    QMap<int, BloccoFile>::const_iterator it = indice.mesi.constFind(chiave);
+    if(it == indice.mesi.constEnd())
+        return QByteArray();
+
+    return leggiBlocco(it.value());
+}
+
+QByteArray ScrittoreAsincrono::leggiRegole(){
+
+    std::lock_guard<std::mutex> lock(mFile);
+    return leggiBlocco(indice.regole);
+}
+
+// da chiamare con mFile bloccato; vuoto anche se il blocco non è stato letto per intero
+QByteArray ScrittoreAsincrono::leggiBlocco(const BloccoFile &blocco){
+
+    if(blocco.lunghezza <= 0 || !snapshot.isOpen() || !snapshot.seek(blocco.inizio))
+        return QByteArray();
+
+    QByteArray dati = snapshot.read(blocco.lunghezza);
+    if(dati.size() != blocco.lunghezza)
+        return QByteArray();
+
+    return dati;
+}
+
+void ScrittoreAsincrono::esegui(){
+
+    std::unique_lock<std::mutex> lock(m);
+
+    while(true){
+        nuoviComandi.wait(lock, [this]{ return chiusura || !comandi.isEmpty(); });
+
+        if(comandi.isEmpty())
+            break;
+
+        QList<Comando> daEseguire;
+        daEseguire.swap(comandi);
+        occupato = true;
+        lock.unlock();
+
+        // le righe consecutive vengono raccolte e scritte insieme
+        QByteArray righe;
+        for(int i = 0; i < daEseguire.size(); ++i){
+            const Comando &comando = daEseguire[i];
+
+            if(comando.tipo == Comando::Riga){
+                righe += comando.riga.toUtf8();
+                righe += '\n';
+                continue;
+            }
+
+            scriviRighe(righe);
+            righe.clear();
+
+            if(comando.tipo == Comando::Snapshot){
+                scriviSnapshot(comando);
+            }else if(comando.inCoda){
+                journal.close();
+                journal.open(QIODevice::Append | QIODevice::Text);
+            }else{
+                ricominciaJournal(comando.generazione);
+            }
+        }
+        scriviRighe(righe);
+
+        lock.lock();
+        occupato = false;
+        if(comandi.isEmpty())
+            codaVuota.notify_all();
+    }
+}
+
+void ScrittoreAsincrono::scriviRighe(const QByteArray &righe){
+
+    if(righe.isEmpty() || !journal.isOpen())
+        return;
+
+    journal.write(righe);
+    journal.flush();
+}
+
+// righe dei task di un mese, in ordine di data
+static QByteArray righeDelMese(const QMap<QDate, QList<Task>> &tasks, int chiave){
+
+    QString righe;
+    QTextStream out(&righe);
+
+    QMap<QDate, QList<Task>>::const_iterator it = tasks.lowerBound(QDate(chiave / 12, chiave % 12 + 1, 1));
+
+    for(; it != tasks.constEnd() && chiaveMese(it.key()) == chiave; ++it){
+
+        const QList<Task> &lista = it.value();
+
+        for(int j = 0; j < lista.size(); ++j){
+            scriviTask(out, it.key(), lista[j]);
+            out << "\n";
+        }
+    }
+
+    out.flush();
+    return righe.toUtf8();
+}
+
+// Scrive lo snapshot un mese alla volta, annotando nell'indice dove inizia
+// ogni mese. Il file è aperto senza QIODevice::Text perché le posizioni
+// nell'indice devono corrispondere ai byte scritti.
+void ScrittoreAsincrono::scriviSnapshot(const Comando &comando){
+
+    // true = mese da scrivere da comando.tasks, false = da copiare dal vecchio snapshot
+    QMap<int, bool> mesi;
+
+    for(QMap<QDate, QList<Task>>::const_iterator it = comando.tasks.constBegin(); it != comando.tasks.constEnd(); ++it){
+        int chiave = chiaveMese(it.key());
+        if(comando.tuttoCaricato || comando.mesiCaricati.contains(chiave))
+            mesi.insert(chiave, true);
+    }
+
+    if(!comando.tuttoCaricato){
+        std::lock_guard<std::mutex> lock(mFile);
+        for(QMap<int, BloccoFile>::const_iterator it = indice.mesi.constBegin(); it != indice.mesi.constEnd(); ++it){
+            if(!comando.mesiCaricati.contains(it.key()))
+                mesi.insert(it.key(), false);
+        }
+    }
+
+    QSaveFile file(percorsoSnapshot);
+
+    if(!file.open(QIODevice::WriteOnly))
+        return;
+
+    IndiceSnapshot nuovo;
+    nuovo.generazione = comando.generazione;
+
+    // se un mese non può essere copiato o un blocco non viene scritto per intero
+    // lo snapshot è abbandonato: il vecchio file e il journal restano validi
+    QByteArray blocco = QString("#generazione;%1\n").arg(comando.generazione).toUtf8();
+    qint64 posizione = file.write(blocco);
+    if(posizione != blocco.size()){
+        file.cancelWriting();
+        return;
+    }
+
+    for(QMap<int, bool>::const_iterator it = mesi.constBegin(); it != mesi.constEnd(); ++it){
+
+        if(it.value()){
+            blocco = righeDelMese(comando.tasks, it.key());
+            if(blocco.isEmpty())
+                continue;
+        }else{
+            std::lock_guard<std::mutex> lock(mFile);
+            // i mesi nell'indice non sono mai vuoti
+            blocco = leggiBlocco(indice.mesi.value(it.key()));
+        }
+
+        if(blocco.isEmpty() || file.write(blocco) != blocco.size()){
+            file.cancelWriting();
+            return;
+        }
+
+        nuovo.mesi.insert(it.key(), BloccoFile{posizione, blocco.size()});
+        posizione += blocco.size();
+    }
+
+    // una riga per regola, con in più la data di fine e le eccezioni
+    QString righe;
+    QTextStream out(&righe);
+    for(int i = 0; i < comando.regole.size(); ++i){
+        scriviRegola(out, comando.regole[i]);
+        out << "\n";
+    }
+    out.flush();
+
+    blocco = righe.toUtf8();
+    nuovo.regole = BloccoFile{posizione, blocco.size()};
+    if(file.write(blocco) != blocco.size()){
+        file.cancelWriting();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mFile);
+
+        // il vecchio snapshot va chiuso prima di sostituirlo
+        snapshot.close();
+
+        // il file viene sostituito solo se è stato scritto per intero,
+        // altrimenti il journal della generazione precedente resta valido
+        bool salvato = file.commit();
+        if(salvato)
+            indice = nuovo;
+
+        // se non si riapre, leggiBlocco non legge più nulla e i prossimi
+        // snapshot parziali vengono abbandonati invece di perdere i mesi da copiare
+        if(!snapshot.open(QIODevice::ReadOnly))
+            qDebug() << "Impossibile riaprire" << percorsoSnapshot;
+
+        if(!salvato)
+            return;
+    }
+
+    // se l'indice non viene scritto, al prossimo avvio la generazione
+    // non corrisponde e attivita.txt viene letto per intero
+    indice.scrivi(percorsoIndice);
+
+    ricominciaJournal(comando.generazione);
+
+    qDebug() << "File salvato in: " << QFileInfo(percorsoSnapshot).absoluteFilePath();
+}
+
+void ScrittoreAsincrono::ricominciaJournal(quint64 generazione){
+
+    journal.close();
+
+    if(!journal.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return;
+
+    journal.write(QString("#generazione;%1\n").arg(generazione).toUtf8());
+    journal.flush();
+}
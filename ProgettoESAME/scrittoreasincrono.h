@@ -0,0 +1,78 @@
+#ifndef SCRITTOREASINCRONO_H
+#define SCRITTOREASINCRONO_H
+
+#include <QDate>
+#include <QFile>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "task.h"
+#include "ricorrenza.h"
+#include "archivio.h"
+
+// Thread dedicato alla scrittura di attivita.txt e del journal.
+// L'interfaccia accoda i comandi e torna subito: le righe del journal
+// in attesa vengono scritte con una sola write e, se più salvataggi
+// completi sono in attesa, viene scritto solo l'ultimo.
+// I salvataggi ricevono copie implicitamente condivise di tasksByDate e
+// regole, quindi accodarli non copia il calendario e le modifiche
+// successive dell'interfaccia non toccano la copia in scrittura.
+// Insieme allo snapshot viene scritto il suo indice per mese, usato
+// dall'interfaccia per leggere solo i mesi che le servono.
+class ScrittoreAsincrono
+{
+public:
+    ScrittoreAsincrono(const QString &percorsoSnapshot, const QString &percorsoJournal, const QString &percorsoIndice);
+    ~ScrittoreAsincrono();
+
+    void apriJournal(quint64 generazione, bool inCoda);
+    void accoda(const QString &riga);
+    void salva(const QMap<QDate, QList<Task>> &tasks, const QList<RegolaRicorrenza> &regole,
+               const QSet<int> &mesiCaricati, bool tuttoCaricato, quint64 generazione);
+    void attendi();
+
+    bool apriIndice(quint64 generazione);
+    QByteArray leggiMese(int chiave);
+    QByteArray leggiRegole();
+
+private:
+    struct Comando{
+        enum Tipo{ ApriJournal, Riga, Snapshot } tipo = Riga;
+        QString riga;
+        QMap<QDate, QList<Task>> tasks;
+        QList<RegolaRicorrenza> regole;
+        QSet<int> mesiCaricati; // mesi di tasks letti dallo snapshot, gli altri si copiano
+        bool tuttoCaricato = true;
+        quint64 generazione = 0;
+        bool inCoda = false;
+    };
+
+    void esegui();
+    void scriviRighe(const QByteArray &righe);
+    void scriviSnapshot(const Comando &comando);
+    void ricominciaJournal(quint64 generazione);
+    QByteArray leggiBlocco(const BloccoFile &blocco);
+
+    QString percorsoSnapshot;
+    QString percorsoIndice;
+    QFile journal; // usato solo dal thread di scrittura
+
+    // snapshot aperto in lettura e il suo indice, condivisi con l'interfaccia
+    std::mutex mFile;
+    QFile snapshot;
+    IndiceSnapshot indice;
+
+    std::mutex m;
+    std::condition_variable nuoviComandi;
+    std::condition_variable codaVuota;
+    QList<Comando> comandi;
+    bool occupato = false;
+    bool chiusura = false;
+    std::thread thread;
+};
+
+#endif // SCRITTOREASINCRONO_H
@@ -0,0 +1,27 @@
+#include "task.h"
+
+QString testoFrequenza(Frequency frequenza){
+
+    switch(frequenza){
+    case Frequency::Daily:
+        return QString("Giornaliera");
+    case Frequency::Weekly:
+        return QString("Settimanale");
+    case Frequency::Monthly:
+        return QString("Mensile");
+    default:
+        return QString("Nessuna");
+    }
+}
+
+Frequency frequenzaDaTesto(const QString &testo){
+
+    if(testo == "Giornaliera")
+        return Frequency::Daily;
+    if(testo == "Settimanale")
+        return Frequency::Weekly;
+    if(testo == "Mensile")
+        return Frequency::Monthly;
+
+    return Frequency::None;
+}
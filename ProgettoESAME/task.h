@@ -0,0 +1,76 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <QString>
+#include <QTime>
+#include "titolo.h"
+
+enum class TaskType{
+    Event,
+    Activity
+};
+
+enum class Frequency{
+    None,
+    Daily,
+    Weekly,
+    Monthly
+};
+
+// Testi della combo e del file per le frequenze:
+// "Nessuna", "Giornaliera", "Settimanale", "Mensile"
+QString testoFrequenza(Frequency frequenza);
+Frequency frequenzaDaTesto(const QString &testo); // None per i testi sconosciuti
+
+// Minuti dall'inizio del giorno, i secondi vengono ignorati
+inline int minutiDelGiorno(const QTime &ora){
+    return ora.hour() * 60 + ora.minute();
+}
+
+// Attività o evento in 8 byte: titolo internato, orari in minuti
+// dall'inizio del giorno e tipo, frequenza e stati in bit accanto
+// all'ora di inizio. QTime e QString servono solo per interfaccia e file.
+struct Task{
+
+    Task() : inizio(0), frequenza(0), attivita(0), conFine(0), completato(0), fine(0) {}
+
+    Titolo title;
+
+    TaskType type() const { return attivita ? TaskType::Activity : TaskType::Event; }
+    void setType(TaskType tipo) { attivita = (tipo == TaskType::Activity); }
+
+    Frequency frequency() const { return Frequency(frequenza); }
+    void setFrequency(Frequency f) { frequenza = quint16(f); }
+
+    bool hasEndTime() const { return conFine; }
+    void setHasEndTime(bool valore) { conFine = valore; }
+
+    bool completed() const { return completato; }
+    void setCompleted(bool valore) { completato = valore; }
+
+    int startMinute() const { return inizio; }
+    int endMinute() const { return fine; } // significativo solo con hasEndTime()
+
+    // minuti tra 0 e 1439
+    void setStartMinute(int minuti) { inizio = quint16(minuti); }
+    void setEndMinute(int minuti) { fine = quint16(minuti); }
+
+    QTime startTime() const { return QTime(inizio / 60, inizio % 60); }
+    QTime endTime() const { return conFine ? QTime(fine / 60, fine % 60) : QTime(); }
+
+    // ore valide, come quelle dei QTimeEdit
+    void setStartTime(const QTime &ora) { setStartMinute(minutiDelGiorno(ora)); }
+    void setEndTime(const QTime &ora) { setEndMinute(minutiDelGiorno(ora)); }
+
+private:
+    quint16 inizio : 11;    // 0 - 1439
+    quint16 frequenza : 2;  // Frequency
+    quint16 attivita : 1;   // TaskType::Activity
+    quint16 conFine : 1;
+    quint16 completato : 1;
+    quint16 fine;
+};
+
+Q_DECLARE_TYPEINFO(Task, Q_MOVABLE_TYPE);
+
+#endif // TASK_H
@@ -0,0 +1,132 @@
+#include "tasktablemodel.h"
+#include <algorithm>
+
+static bool iniziaPrima(const VoceGiorno &a, const VoceGiorno &b){
+    return a.task.startMinute() < b.task.startMinute();
+}
+
+TaskTableModel::TaskTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int TaskTableModel::rowCount(const QModelIndex &parent) const{
+    return parent.isValid() ? 0 : voci.size();
+}
+
+int TaskTableModel::columnCount(const QModelIndex &parent) const{
+    return parent.isValid() ? 0 : 5;
+}
+
+QVariant TaskTableModel::data(const QModelIndex &index, int role) const{
+
+    if(!index.isValid() || role != Qt::DisplayRole || index.row() >= voci.size())
+        return QVariant();
+
+    const Task &task = voci[index.row()].task;
+
+    switch(index.column()){
+    case 0:
+        return (task.type() == TaskType::Event) ? QString("Evento") : QString("Attività");
+    case 1:
+        return task.title.testo();
+    case 2:
+        return task.startTime().toString("HH:mm");
+    case 3:
+        return task.hasEndTime() ? task.endTime().toString("HH:mm") : QString("-");
+    case 4:
+        return testoFrequenza(task.frequency());
+    }
+
+    return QVariant();
+}
+
+QVariant TaskTableModel::headerData(int section, Qt::Orientation orientation, int role) const{
+
+    if(orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    switch(section){
+    case 0: return QString("Tipo");
+    case 1: return QString("Titolo");
+    case 2: return QString("Ora inizio");
+    case 3: return QString("Ora fine");
+    case 4: return QString("Frequenza");
+    }
+
+    return QVariant();
+}
+
+// Prima riga che inizia dopo startMinute: a parità di orario
+// la nuova voce va dopo quelle già presenti
+int TaskTableModel::posizione(int startMinute) const{
+
+    VoceGiorno chiave;
+    chiave.task.setStartMinute(startMinute);
+
+    return std::upper_bound(voci.begin(), voci.end(), chiave, iniziaPrima) - voci.begin();
+}
+
+// Sostituisce tutte le righe, usato quando cambia il giorno mostrato
+void TaskTableModel::impostaVoci(QList<VoceGiorno> nuove){
+
+    std::stable_sort(nuove.begin(), nuove.end(), iniziaPrima);
+
+    beginResetModel();
+    voci.swap(nuove);
+    endResetModel();
+}
+
+int TaskTableModel::inserisci(const VoceGiorno &voce){
+
+    int row = posizione(voce.task.startMinute());
+
+    beginInsertRows(QModelIndex(), row, row);
+    voci.insert(row, voce);
+    endInsertRows();
+
+    return row;
+}
+
+// Sostituisce la voce di una riga e la sposta se è cambiata l'ora di inizio,
+// restituisce la nuova posizione
+int TaskTableModel::aggiorna(int row, const VoceGiorno &voce){
+
+    VoceGiorno vecchia = voci.takeAt(row);
+    int nuova = posizione(voce.task.startMinute());
+
+    if(nuova != row){
+        // la destinazione di beginMoveRows è contata prima dello spostamento
+        voci.insert(row, vecchia);
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), nuova > row ? nuova + 1 : nuova);
+        voci.move(row, nuova);
+        endMoveRows();
+        voci[nuova] = voce;
+    }else{
+        voci.insert(row, voce);
+    }
+
+    emit dataChanged(index(nuova, 0), index(nuova, columnCount() - 1));
+    return nuova;
+}
+
+void TaskTableModel::rimuovi(int row){
+
+    int indiceTask = voci[row].indiceTask;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    voci.removeAt(row);
+    endRemoveRows();
+
+    // i task successivi in tasksByDate scalano di una posizione
+    if(indiceTask >= 0){
+        for(int i = 0; i < voci.size(); ++i){
+            if(voci[i].indiceTask > indiceTask)
+                --voci[i].indiceTask;
+        }
+    }
+}
+
+const VoceGiorno &TaskTableModel::voce(int row) const{
+    return voci[row];
+}
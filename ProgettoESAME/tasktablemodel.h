@@ -0,0 +1,43 @@
+#ifndef TASKTABLEMODEL_H
+#define TASKTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include "task.h"
+
+// Riga della tabella: un task di tasksByDate oppure l'istanza di una regola
+struct VoceGiorno{
+    Task task;
+    int indiceTask;    // posizione in tasksByDate[data], -1 per le istanze
+    int indiceRegola;  // posizione in regole, -1 per i task singoli
+};
+
+// Modello delle attività del giorno mostrato, ordinate per ora di inizio.
+// Le modifiche emettono solo i segnali delle righe interessate, così la
+// vista non ricrea la tabella ad ogni inserimento, modifica o cancellazione.
+class TaskTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit TaskTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void impostaVoci(QList<VoceGiorno> voci);
+    int inserisci(const VoceGiorno &voce);
+    int aggiorna(int row, const VoceGiorno &voce);
+    void rimuovi(int row);
+
+    const VoceGiorno &voce(int row) const;
+
+private:
+    int posizione(int startMinute) const;
+
+    QList<VoceGiorno> voci;
+};
+
+#endif // TASKTABLEMODEL_H
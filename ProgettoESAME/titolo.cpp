@@ -0,0 +1,81 @@
+#include "titolo.h"
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QVector>
+
+namespace {
+
+// testi[i] è il titolo con indice i, indici associa i byte UTF-8 all'indice
+struct PoolTitoli{
+    QReadWriteLock lock;
+    QVector<QString> testi;
+    QHash<QByteArray, quint32> indici;
+
+    PoolTitoli(){
+        testi.append(QString());
+        indici.insert(QByteArray(), 0);
+    }
+};
+
+// Il pool non viene mai distrutto, così i titoli restano validi
+// anche durante la distruzione degli oggetti statici
+PoolTitoli &pool(){
+    static PoolTitoli *p = new PoolTitoli;
+    return *p;
+}
+
+}
+
+Titolo::Titolo(const QString &testo){
+
+    const QByteArray utf8 = testo.toUtf8();
+    indice = daUtf8(utf8.constData(), utf8.size()).indice;
+}
+
+Titolo Titolo::daUtf8(const char *testo, int lunghezza){
+
+    PoolTitoli &p = pool();
+
+    // chiave che usa i byte della riga senza copiarli, valida solo per la ricerca
+    const QByteArray chiave = QByteArray::fromRawData(testo, lunghezza);
+    Titolo titolo;
+
+    {
+        QReadLocker lettura(&p.lock);
+        QHash<QByteArray, quint32>::const_iterator it = p.indici.constFind(chiave);
+        if(it != p.indici.constEnd()){
+            titolo.indice = it.value();
+            return titolo;
+        }
+    }
+
+    QWriteLocker scrittura(&p.lock);
+
+    // un altro thread può averlo aggiunto nel frattempo
+    QHash<QByteArray, quint32>::const_iterator it = p.indici.constFind(chiave);
+    if(it != p.indici.constEnd()){
+        titolo.indice = it.value();
+        return titolo;
+    }
+
+    titolo.indice = quint32(p.testi.size());
+    p.testi.append(QString::fromUtf8(testo, lunghezza));
+    p.indici.insert(QByteArray(testo, lunghezza), titolo.indice);
+
+    return titolo;
+}
+
+QString Titolo::testo() const{
+
+    PoolTitoli &p = pool();
+    QReadLocker lettura(&p.lock);
+    return p.testi.at(int(indice));
+}
+
+int Titolo::numeroTitoli(){
+
+    PoolTitoli &p = pool();
+    QReadLocker lettura(&p.lock);
+    return p.testi.size();
+}
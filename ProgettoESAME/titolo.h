@@ -0,0 +1,33 @@
+#ifndef TITOLO_H
+#define TITOLO_H
+
+#include <QString>
+
+// Titolo di un task, memorizzato una sola volta in un pool globale:
+// il task contiene solo l'indice del testo, e i task con lo stesso titolo
+// (per esempio tutte le istanze di una ricorrenza) condividono la stessa copia.
+// Il pool è letto anche dal thread di scrittura, quindi è protetto da un
+// QReadWriteLock; i testi non vengono mai rimossi e gli indici restano validi.
+class Titolo
+{
+public:
+    Titolo() : indice(0) {} // titolo vuoto
+    explicit Titolo(const QString &testo);
+
+    // cerca il testo direttamente sui byte, senza copiarli se è già nel pool
+    static Titolo daUtf8(const char *testo, int lunghezza);
+
+    QString testo() const;
+
+    bool operator==(const Titolo &altro) const { return indice == altro.indice; }
+    bool operator!=(const Titolo &altro) const { return indice != altro.indice; }
+
+    static int numeroTitoli();
+
+private:
+    quint32 indice;
+};
+
+Q_DECLARE_TYPEINFO(Titolo, Q_MOVABLE_TYPE);
+
+#endif // TITOLO_H